@@ -0,0 +1,164 @@
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Arena.h"
+#include "Animation.h"
+#include "CollisionMask.h"
+
+#define LOG(argument) std::cout << argument << '\n'
+
+int AnimationClip::frame_at(float time) const
+{
+    // Clips are a handful of frames long, so a binary search over the
+    // cumulative timeline beats dividing on every lookup
+    const float *frame = std::upper_bound(frame_end_times, frame_end_times + frame_count, time);
+    if (frame == frame_end_times + frame_count) return frame_count - 1;
+
+    return (int) (frame - frame_end_times);
+}
+
+bool AnimationLibrary::load(Arena &arena, const char *filepath)
+{
+    std::ifstream infile(filepath);
+
+    if (infile.fail())
+    {
+        LOG("Error opening animation file: " << filepath);
+        return false;
+    }
+
+    // Read the directives first so the clip table can be allocated in one go
+    std::vector<std::string> lines;
+    std::string line;
+    int clip_count = 0;
+
+    while (std::getline(infile, line))
+    {
+        std::string::size_type comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        std::istringstream tokens(line);
+        std::string directive;
+        if (!(tokens >> directive)) continue;
+
+        if (directive == "clip") clip_count++;
+        lines.push_back(line);
+    }
+
+    m_clips      = arena.allocate_array<AnimationClip>(clip_count);
+    m_clip_count = 0;
+
+    if (m_clips == NULL && clip_count > 0) return false;
+
+    for (const std::string &directive_line : lines)
+    {
+        std::istringstream tokens(directive_line);
+        std::string directive;
+        tokens >> directive;
+
+        if (directive == "sheet")
+        {
+            if (!(tokens >> m_cols >> m_rows) || m_cols <= 0 || m_rows <= 0)
+            {
+                LOG("Bad sheet size in " << filepath << ": " << directive_line);
+                return false;
+            }
+        }
+        else if (directive == "clip")
+        {
+            std::string name;
+            float seconds_per_frame;
+
+            if (!(tokens >> name >> seconds_per_frame) || seconds_per_frame <= 0.0f)
+            {
+                LOG("Bad clip in " << filepath << ": " << directive_line);
+                return false;
+            }
+
+            std::vector<int> indices;
+            int index;
+            while (tokens >> index) indices.push_back(index);
+
+            if (indices.empty())
+            {
+                LOG("Clip " << name << " in " << filepath << " has no frames");
+                return false;
+            }
+
+            AnimationClip &clip = m_clips[m_clip_count];
+            strncpy(clip.name, name.c_str(), sizeof(clip.name) - 1);
+            clip.name[sizeof(clip.name) - 1] = '\0';
+            clip.frame_count     = (int) indices.size();
+            clip.frames          = arena.allocate_array<AnimationFrame>(clip.frame_count);
+            clip.frame_end_times = arena.allocate_array<float>(clip.frame_count);
+            clip.duration        = 0.0f;
+
+            if (clip.frames == NULL || clip.frame_end_times == NULL) return false;
+
+            // Work out each frame's UV rectangle once, here, instead of with a
+            // modulo and two divisions on every draw
+            float width  = 1.0f / (float) m_cols;
+            float height = 1.0f / (float) m_rows;
+
+            for (int i = 0; i < clip.frame_count; i++)
+            {
+                AnimationFrame &frame = clip.frames[i];
+                frame.u      = (float) (indices[i] % m_cols) * width;
+                frame.v      = (float) (indices[i] / m_cols) * height;
+                frame.width  = width;
+                frame.height = height;
+
+                float quad[] =
+                {
+                    frame.u, frame.v + height, frame.u + width, frame.v + height, frame.u + width, frame.v,
+                    frame.u, frame.v + height, frame.u + width, frame.v,          frame.u,         frame.v
+                };
+                std::copy(quad, quad + 12, frame.tex_coords);
+                frame.mask = NULL;
+
+                clip.duration += seconds_per_frame;
+                clip.frame_end_times[i] = clip.duration;
+            }
+
+            m_clip_count++;
+        }
+        else
+        {
+            LOG("Unknown directive in " << filepath << ": " << directive);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+const AnimationClip *AnimationLibrary::get_clip(const char *name) const
+{
+    for (int i = 0; i < m_clip_count; i++)
+    {
+        if (strcmp(m_clips[i].name, name) == 0) return &m_clips[i];
+    }
+
+    return NULL;
+}
+
+bool AnimationLibrary::build_masks(Arena &arena, const CollisionMaskImage &sheet, float world_width,
+                                   float world_height)
+{
+    for (int i = 0; i < m_clip_count; i++)
+    {
+        for (int j = 0; j < m_clips[i].frame_count; j++)
+        {
+            AnimationFrame &frame = m_clips[i].frames[j];
+            frame.mask = create_collision_mask(arena, sheet, frame.u, frame.v, frame.width, frame.height,
+                                               world_width, world_height);
+            if (frame.mask == NULL) return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+
+class Arena;
+struct CollisionMask;
+struct CollisionMaskImage;
+
+// One frame of a clip, with the quad's texture coordinates already laid out in
+// the same vertex order Entity::render uses, so drawing it is a pointer hand-off.
+struct AnimationFrame
+{
+    float u, v, width, height;
+    float tex_coords[12];
+    const CollisionMask *mask;   // NULL until AnimationLibrary::build_masks()
+};
+
+struct AnimationClip
+{
+    char name[32];
+    AnimationFrame *frames;
+    float *frame_end_times; // cumulative, one per frame
+    int frame_count;
+    float duration;
+
+    int frame_at(float time) const;
+};
+
+/**
+ * Owns every clip described by a sprite sheet's .anim file. Entities only keep
+ * const pointers into the library, so one set of UV tables is shared by every
+ * entity that uses the sheet. Clips and frames are allocated from the level
+ * arena and go away with it.
+ *
+ * File format, one directive per line ('#' starts a comment):
+ *
+ *     sheet <columns> <rows>
+ *     clip <name> <seconds per frame> <atlas index> <atlas index> ...
+ */
+class AnimationLibrary
+{
+private:
+    AnimationClip *m_clips = NULL;
+    int m_clip_count       = 0;
+    int m_cols             = 1;
+    int m_rows             = 1;
+
+public:
+    bool load(Arena &arena, const char *filepath);
+    const AnimationClip *get_clip(const char *name) const;
+
+    // Gives every frame a collision mask cut from the sheet's, for frames
+    // drawn world_width x world_height
+    bool build_masks(Arena &arena, const CollisionMaskImage &sheet, float world_width, float world_height);
+
+    int const get_clip_count() const { return m_clip_count; };
+};
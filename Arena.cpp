@@ -0,0 +1,50 @@
+#include <iostream>
+#include <cstdint>
+#include "Arena.h"
+
+#define LOG(argument) std::cout << argument << '\n'
+
+Arena::Arena(size_t capacity)
+{
+    m_capacity = capacity;
+    m_memory   = new unsigned char[capacity];
+}
+
+Arena::~Arena()
+{
+    reset();
+    delete [] m_memory;
+}
+
+void *Arena::allocate(size_t size, size_t alignment)
+{
+    uintptr_t base    = (uintptr_t) m_memory;
+    uintptr_t aligned = (base + m_used + alignment - 1) & ~(uintptr_t) (alignment - 1);
+    size_t new_used   = (size_t) (aligned - base) + size;
+
+    if (new_used > m_capacity)
+    {
+        LOG("Arena out of memory: " << size << " bytes requested, "
+            << m_capacity - m_used << " of " << m_capacity << " left.");
+        return NULL;
+    }
+
+    m_used = new_used;
+    if (m_used > m_high_water) m_high_water = m_used;
+    m_allocations++;
+
+    return (void *) aligned;
+}
+
+void Arena::reset()
+{
+    // Finalizers were pushed as objects were created, so this runs them newest first
+    for (Finalizer *finalizer = m_finalizers; finalizer != NULL; finalizer = finalizer->next)
+    {
+        finalizer->destroy(finalizer->objects, finalizer->count);
+    }
+
+    m_finalizers  = NULL;
+    m_used        = 0;
+    m_allocations = 0;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Level-scoped bump allocator.
+ *
+ * Everything a level needs (entities, animation tables, flow field grids) is
+ * carved out of one block that is allocated once at startup. Loading a level
+ * is a run of pointer bumps and unloading it is a single reset(), which runs
+ * the destructors of any non-trivial objects in reverse order and rewinds the
+ * block. Nothing is freed piecemeal, so nothing can leak.
+ *
+ * The high-water mark survives resets so the block can be sized from real
+ * levels.
+ */
+class Arena
+{
+private:
+    // Destructors to run on reset(), stored in the arena itself as a stack
+    struct Finalizer
+    {
+        void (*destroy)(void *objects, int count);
+        void *objects;
+        int count;
+        Finalizer *next;
+    };
+
+    unsigned char *m_memory;
+    size_t m_capacity;
+    size_t m_used       = 0;
+    size_t m_high_water = 0;
+    int m_allocations   = 0;
+    Finalizer *m_finalizers = NULL;
+
+    template <typename T>
+    static void destroy_objects(void *objects, int count)
+    {
+        T *typed = static_cast<T *>(objects);
+        for (int i = count - 1; i >= 0; i--) typed[i].~T();
+    }
+
+public:
+    // ––––– METHODS ––––– //
+    Arena(size_t capacity);
+    ~Arena();
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    void reset();
+
+    template <typename T>
+    T *allocate_array(int count)
+    {
+        return static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    template <typename T, typename... Args>
+    T *create(Args &&... args)
+    {
+        return create_array<T>(1, std::forward<Args>(args)...);
+    }
+
+    template <typename T, typename... Args>
+    T *create_array(int count, Args &&... args)
+    {
+        T *objects = allocate_array<T>(count);
+        if (objects == NULL) return NULL;
+
+        for (int i = 0; i < count; i++) new (&objects[i]) T(args...);
+
+        if (!std::is_trivially_destructible<T>::value)
+        {
+            Finalizer *finalizer = static_cast<Finalizer *>(allocate(sizeof(Finalizer), alignof(Finalizer)));
+            if (finalizer == NULL)
+            {
+                destroy_objects<T>(objects, count);
+                return NULL;
+            }
+
+            finalizer->destroy = &destroy_objects<T>;
+            finalizer->objects = objects;
+            finalizer->count   = count;
+            finalizer->next    = m_finalizers;
+            m_finalizers       = finalizer;
+        }
+
+        return objects;
+    }
+
+    // ––––– GETTERS ––––– //
+    size_t const get_capacity()    const { return m_capacity;    };
+    size_t const get_used()        const { return m_used;        };
+    size_t const get_high_water()  const { return m_high_water;  };
+    int    const get_allocations() const { return m_allocations; };
+};
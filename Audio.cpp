@@ -0,0 +1,161 @@
+#include <iostream>
+#include "Audio.h"
+
+#define LOG(argument) std::cout << argument << '\n'
+
+const int AUDIO_CHANNELS     = 2,
+          AUDIO_CHUNK_SIZE   = 1024,
+          AUDIO_IDLE_WAIT_MS = 100;
+
+bool AudioEngine::initialise(const char *const effect_filepaths[SFX_COUNT], const char *music_filepath)
+{
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0 ||
+        Mix_OpenAudio(MIX_DEFAULT_FREQUENCY, MIX_DEFAULT_FORMAT, AUDIO_CHANNELS, AUDIO_CHUNK_SIZE) != 0)
+    {
+        LOG("Unable to open audio (" << SDL_GetError() << "), falling back to the dummy driver.");
+
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+
+        if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0 ||
+            Mix_OpenAudio(MIX_DEFAULT_FREQUENCY, MIX_DEFAULT_FORMAT, AUDIO_CHANNELS, AUDIO_CHUNK_SIZE) != 0)
+        {
+            LOG("Unable to open audio: " << Mix_GetError());
+            return false;
+        }
+    }
+
+    m_is_open = true;
+
+    // One channel per effect: retriggering reuses its channel rather than
+    // hunting for a free one, and a looping effect can be stopped by index
+    Mix_AllocateChannels(SFX_COUNT);
+
+    // Decode every effect up front so nothing touches the disk mid-game
+    for (int i = 0; i < SFX_COUNT; i++)
+    {
+        m_effects[i] = Mix_LoadWAV(effect_filepaths[i]);
+        if (m_effects[i] == NULL) LOG("Unable to load sound effect " << effect_filepaths[i] << ": " << Mix_GetError());
+    }
+
+    // Music is left on disk and streamed by the mixer
+    m_music = Mix_LoadMUS(music_filepath);
+    if (m_music == NULL) LOG("Unable to load music " << music_filepath << ": " << Mix_GetError());
+
+    m_wakeup = SDL_CreateSemaphore(0);
+    m_is_running = true;
+    m_thread = std::thread(&AudioEngine::run, this);
+
+    return true;
+}
+
+void AudioEngine::shutdown()
+{
+    if (!m_is_open) return;
+
+    m_is_running = false;
+    SDL_SemPost(m_wakeup);
+    m_thread.join();
+    SDL_DestroySemaphore(m_wakeup);
+
+    Mix_HaltMusic();
+    Mix_HaltChannel(-1);
+
+    for (int i = 0; i < SFX_COUNT; i++)
+    {
+        if (m_effects[i] != NULL) Mix_FreeChunk(m_effects[i]);
+        m_effects[i] = NULL;
+    }
+    if (m_music != NULL) Mix_FreeMusic(m_music);
+    m_music = NULL;
+
+    Mix_CloseAudio();
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    m_is_open = false;
+}
+
+// ––––– GAME THREAD ––––– //
+bool AudioEngine::push(Command command)
+{
+    if (!m_is_open) return false;
+
+    unsigned int head = m_head.load(std::memory_order_relaxed);
+    unsigned int tail = m_tail.load(std::memory_order_acquire);
+
+    if (head - tail >= QUEUE_SIZE)
+    {
+        m_dropped_commands++;
+        return false;
+    }
+
+    m_queue[head & (QUEUE_SIZE - 1)] = command;
+    m_head.store(head + 1, std::memory_order_release);
+
+    // Posting a semaphore never waits on the audio thread
+    SDL_SemPost(m_wakeup);
+    return true;
+}
+
+void AudioEngine::play_effect(SoundEffect effect, int loops)
+{
+    push({ Command::PLAY_EFFECT, effect, loops });
+}
+
+void AudioEngine::stop_effect(SoundEffect effect)
+{
+    push({ Command::STOP_EFFECT, effect, 0 });
+}
+
+void AudioEngine::play_music()
+{
+    push({ Command::PLAY_MUSIC, 0, -1 });
+}
+
+void AudioEngine::stop_music()
+{
+    push({ Command::STOP_MUSIC, 0, 0 });
+}
+
+// ––––– AUDIO THREAD ––––– //
+void AudioEngine::run()
+{
+    while (m_is_running)
+    {
+        SDL_SemWaitTimeout(m_wakeup, AUDIO_IDLE_WAIT_MS);
+
+        unsigned int tail = m_tail.load(std::memory_order_relaxed);
+        unsigned int head = m_head.load(std::memory_order_acquire);
+
+        while (tail != head)
+        {
+            execute(m_queue[tail & (QUEUE_SIZE - 1)]);
+            tail++;
+            m_tail.store(tail, std::memory_order_release);
+        }
+    }
+}
+
+void AudioEngine::execute(const Command &command)
+{
+    switch (command.type)
+    {
+        case Command::PLAY_EFFECT:
+            if (m_effects[command.effect] != NULL)
+            {
+                Mix_PlayChannel(command.effect, m_effects[command.effect], command.loops);
+            }
+            break;
+
+        case Command::STOP_EFFECT:
+            Mix_HaltChannel(command.effect);
+            break;
+
+        case Command::PLAY_MUSIC:
+            if (m_music != NULL) Mix_PlayMusic(m_music, command.loops);
+            break;
+
+        case Command::STOP_MUSIC:
+            Mix_HaltMusic();
+            break;
+    }
+}
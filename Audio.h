@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <SDL.h>
+#include <SDL_mixer.h>
+
+enum SoundEffect { SFX_THRUSTER, SFX_BUBBLE, SFX_WIN, SFX_LOSE, SFX_COUNT };
+
+/**
+ * SDL_mixer front end that the game thread can call without ever blocking.
+ *
+ * Every effect is decoded into a Mix_Chunk once in initialise() and gets its
+ * own reserved mixer channel, so retriggering an effect reuses the same chunk
+ * and channel instead of loading or allocating anything. Music is streamed
+ * from disk by SDL_mixer.
+ *
+ * Mix_* calls take the audio device lock, so the game thread never makes them.
+ * It pushes commands into a single-producer/single-consumer ring buffer and a
+ * dedicated audio thread drains it. A full queue drops the command rather than
+ * waiting.
+ *
+ * If no audio device can be opened, the SDL "dummy" driver is tried before
+ * giving up, so the game also runs headless (e.g. SDL_AUDIODRIVER=dummy in CI).
+ */
+class AudioEngine
+{
+private:
+    struct Command
+    {
+        enum Type { PLAY_EFFECT, STOP_EFFECT, PLAY_MUSIC, STOP_MUSIC } type;
+        int effect;
+        int loops;
+    };
+
+    static const unsigned int QUEUE_SIZE = 64; // must be a power of two
+
+    Command m_queue[QUEUE_SIZE];
+    std::atomic<unsigned int> m_head { 0 }; // next slot the game thread writes
+    std::atomic<unsigned int> m_tail { 0 }; // next slot the audio thread reads
+    std::atomic<bool> m_is_running { false };
+    std::atomic<int> m_dropped_commands { 0 };
+
+    Mix_Chunk *m_effects[SFX_COUNT] = { NULL };
+    Mix_Music *m_music = NULL;
+    bool m_is_open     = false;
+
+    std::thread m_thread;
+    SDL_sem *m_wakeup = NULL;
+
+    bool push(Command command);
+    void run();
+    void execute(const Command &command);
+
+public:
+    // ––––– METHODS ––––– //
+    bool initialise(const char *const effect_filepaths[SFX_COUNT], const char *music_filepath);
+    void shutdown();
+
+    void play_effect(SoundEffect effect, int loops = 0);
+    void stop_effect(SoundEffect effect);
+    void play_music();
+    void stop_music();
+
+    // ––––– GETTERS ––––– //
+    bool const is_open()              const { return m_is_open;          };
+    int  const get_dropped_commands() const { return m_dropped_commands; };
+};
@@ -0,0 +1,256 @@
+#ifndef _WINDOWS
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <ctime>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define LOG(argument) std::cout << argument << '\n'
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+#include "Bridge.h"
+
+// Futexes and the flags beside them are plain 32-bit words in memory both
+// processes map
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "atomics must be bare words");
+
+const size_t CACHE_LINE = 64;
+
+static size_t round_up(size_t size)
+{
+    return (size + CACHE_LINE - 1) & ~(CACHE_LINE - 1);
+}
+
+// A pid of 0 is a client that has not attached yet
+static bool is_process_alive(uint32_t pid)
+{
+#ifdef _WINDOWS
+    (void) pid;
+    return true;
+#else
+    // EPERM means it exists under another user
+    return pid == 0 || kill((pid_t) pid, 0) == 0 || errno != ESRCH;
+#endif
+}
+
+Bridge::~Bridge()
+{
+    close();
+}
+
+// ––––– SETUP ––––– //
+bool Bridge::create(const char *name, int env_count, int observation_size, int action_size, int image_size)
+{
+#ifdef _WINDOWS
+    LOG("The training bridge needs POSIX shared memory, which this platform does not have.");
+    return false;
+#else
+    size_t observations = round_up(sizeof(BridgeHeader));
+    size_t actions      = round_up(observations + (size_t) env_count * observation_size * sizeof(float));
+    size_t rewards      = round_up(actions + (size_t) env_count * action_size * sizeof(float));
+    size_t dones        = round_up(rewards + (size_t) env_count * sizeof(float));
+    size_t images       = round_up(dones + (size_t) env_count);
+    size_t image_stride = round_up((size_t) image_size);
+    size_t size         = round_up(images + (size_t) env_count * image_stride);
+
+    // A region left behind by a run that crashed is replaced, not reused
+    shm_unlink(name);
+    int descriptor = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (descriptor < 0)
+    {
+        LOG("Unable to create shared memory " << name << ".");
+        return false;
+    }
+
+    void *mapping = MAP_FAILED;
+    if (ftruncate(descriptor, (off_t) size) == 0)
+    {
+        mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    }
+    ::close(descriptor);   // the mapping keeps the object open
+
+    if (mapping == MAP_FAILED)
+    {
+        LOG("Unable to map shared memory " << name << ".");
+        shm_unlink(name);
+        return false;
+    }
+
+    m_region      = (unsigned char *) mapping;
+    m_region_size = size;
+    m_is_server   = true;
+    strncpy(m_name, name, sizeof(m_name) - 1);
+
+    // The object comes zero-filled, so every array starts cleared
+    m_header = new (m_region) BridgeHeader();
+    m_header->version             = BRIDGE_VERSION;
+    m_header->env_count           = (uint32_t) env_count;
+    m_header->observation_size    = (uint32_t) observation_size;
+    m_header->action_size         = (uint32_t) action_size;
+    m_header->observations_offset = (uint32_t) observations;
+    m_header->actions_offset      = (uint32_t) actions;
+    m_header->rewards_offset      = (uint32_t) rewards;
+    m_header->dones_offset        = (uint32_t) dones;
+    m_header->image_size          = (uint32_t) image_size;
+    m_header->image_stride        = (uint32_t) image_stride;
+    m_header->images_offset       = (uint32_t) images;
+    m_header->region_size         = (uint32_t) size;
+    m_last_seen                   = 0;
+
+    // The magic goes in last: a client that sees it sees everything above
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(m_header->magic, BRIDGE_MAGIC, sizeof(m_header->magic));
+    return true;
+#endif
+}
+
+bool Bridge::open(const char *name)
+{
+#ifdef _WINDOWS
+    LOG("The training bridge needs POSIX shared memory, which this platform does not have.");
+    return false;
+#else
+    int descriptor = shm_open(name, O_RDWR, 0);
+    if (descriptor < 0) return false;
+
+    struct stat status;
+    void *mapping = MAP_FAILED;
+    if (fstat(descriptor, &status) == 0 && status.st_size >= (off_t) sizeof(BridgeHeader))
+    {
+        mapping = mmap(NULL, (size_t) status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    }
+    ::close(descriptor);
+
+    if (mapping == MAP_FAILED) return false;
+
+    BridgeHeader *header = (BridgeHeader *) mapping;
+    bool is_valid = memcmp(header->magic, BRIDGE_MAGIC, sizeof(header->magic)) == 0;
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (!is_valid || header->version != BRIDGE_VERSION || header->region_size != (uint32_t) status.st_size)
+    {
+        munmap(mapping, (size_t) status.st_size);
+        return false;
+    }
+
+    m_region      = (unsigned char *) mapping;
+    m_region_size = (size_t) status.st_size;
+    m_header      = header;
+    m_is_server   = false;
+    m_last_seen   = m_header->response.load();
+    strncpy(m_name, name, sizeof(m_name) - 1);
+
+    m_header->client_pid.store((uint32_t) getpid());
+    return true;
+#endif
+}
+
+void Bridge::close()
+{
+#ifndef _WINDOWS
+    if (m_region == NULL) return;
+
+    munmap(m_region, m_region_size);
+    if (m_is_server) shm_unlink(m_name);
+#endif
+
+    m_region = NULL;
+    m_header = NULL;
+}
+
+// ––––– WAITING ––––– //
+bool Bridge::wait_for_change(std::atomic<uint32_t> &counter, uint32_t seen, std::atomic<uint32_t> &waiting,
+                             const std::atomic<uint32_t> *peer_pid)
+{
+    // With one hardware thread the other side cannot run while this one
+    // spins, so go straight to sleeping
+    static const int spin_count = std::thread::hardware_concurrency() > 1 ? SPIN_COUNT : 0;
+
+    for (int i = 0; i < spin_count; i++)
+    {
+        if (counter.load(std::memory_order_acquire) != seen) return true;
+#if defined(__SSE2__)
+        _mm_pause();
+#endif
+    }
+
+    // The flag goes up before the last check, and the other side bumps the
+    // counter before it looks at the flag, so one of the two always sees the
+    // other and no wake-up is lost
+    auto next_check = std::chrono::steady_clock::now() + std::chrono::milliseconds(PEER_CHECK_MS);
+    waiting.store(1);
+    while (counter.load() == seen)
+    {
+#ifdef __linux__
+        // Not FUTEX_PRIVATE: the word is shared with another process. The
+        // timeout only bounds how long a missed edge could cost.
+        struct timespec timeout = { 0, 100 * 1000 * 1000 };
+        syscall(SYS_futex, (uint32_t *) &counter, FUTEX_WAIT, seen, &timeout, NULL, 0);
+#else
+        std::this_thread::yield();
+#endif
+
+        if (peer_pid != NULL && std::chrono::steady_clock::now() >= next_check)
+        {
+            if (!is_process_alive(peer_pid->load()))
+            {
+                waiting.store(0, std::memory_order_relaxed);
+                return false;
+            }
+            next_check = std::chrono::steady_clock::now() + std::chrono::milliseconds(PEER_CHECK_MS);
+        }
+    }
+    waiting.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+void Bridge::signal(std::atomic<uint32_t> &counter, std::atomic<uint32_t> &waiting)
+{
+    counter.fetch_add(1);
+
+#ifdef __linux__
+    if (waiting.load()) syscall(SYS_futex, (uint32_t *) &counter, FUTEX_WAKE, 1, NULL, NULL, 0);
+#else
+    (void) waiting;   // the other side polls
+#endif
+}
+
+// ––––– SERVER ––––– //
+BridgeCommand Bridge::wait_for_request()
+{
+    if (!wait_for_change(m_header->request, m_last_seen, m_header->server_waiting, &m_header->client_pid))
+    {
+        return BRIDGE_DISCONNECT;
+    }
+    m_last_seen = m_header->request.load(std::memory_order_acquire);
+
+    return (BridgeCommand) m_header->command.load(std::memory_order_relaxed);
+}
+
+void Bridge::respond()
+{
+    signal(m_header->response, m_header->client_waiting);
+}
+
+// ––––– CLIENT ––––– //
+void Bridge::send(BridgeCommand command)
+{
+    m_header->command.store((uint32_t) command, std::memory_order_relaxed);
+    signal(m_header->request, m_header->server_waiting);
+
+    wait_for_change(m_header->response, m_last_seen, m_header->client_waiting);
+    m_last_seen = m_header->response.load(std::memory_order_acquire);
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Lets a training process on the same machine drive a batch of landers
+ * through one POSIX shared-memory region, with no copies and no per-step
+ * system calls while both sides are busy.
+ *
+ * The region is a header followed by five arrays, each starting on its own
+ * cache line so neither side's writes land on a line the other is writing:
+ *
+ *     observations  float[env_count][observation_size]   written by the game
+ *     actions       float[env_count][action_size]        written by the client
+ *     rewards       float[env_count]                     written by the game
+ *     dones         uint8_t[env_count]                   written by the game
+ *     images        uint8_t[env_count][image_stride]     written by the game
+ *
+ * Each environment's image takes image_size bytes at the start of its own
+ * run of whole cache lines; image_size may be 0 for none.
+ *
+ * One step is one round trip for the whole batch. The client fills in the
+ * actions, sets the command and bumps `request`; the game runs the command
+ * for every environment, fills in the results and bumps `response`. Each
+ * side waits for the other's counter by spinning for a while and only then
+ * sleeping on it (a futex on Linux, a yield loop elsewhere). It raises its
+ * `*_waiting` flag before it sleeps, and the other side only makes the wake
+ * call when that flag is up, so a client stepping back to back never enters
+ * the kernel.
+ *
+ * The game is the server: it creates the region and removes it on shutdown.
+ * A client records its process id when it attaches, and a server left
+ * waiting checks now and then that the process is still there, so a client
+ * that crashes or is interrupted ends the run instead of leaving the game
+ * holding the region forever.
+ * tools/bridge_client.cpp is a small reference client.
+ */
+const char     BRIDGE_MAGIC[4] = { 'L', 'L', 'B', 'R' };
+const uint32_t BRIDGE_VERSION  = 3;
+
+// BRIDGE_DISCONNECT is never sent: wait_for_request() returns it when the
+// client's process has gone
+enum BridgeCommand { BRIDGE_NONE = 0, BRIDGE_RESET = 1, BRIDGE_STEP = 2, BRIDGE_QUIT = 3, BRIDGE_DISCONNECT = 4 };
+
+struct BridgeHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t env_count;
+    uint32_t observation_size;     // floats per environment
+    uint32_t action_size;
+    uint32_t observations_offset;  // in bytes from the start of the region
+    uint32_t actions_offset;
+    uint32_t rewards_offset;
+    uint32_t dones_offset;
+    uint32_t image_size;           // bytes per environment
+    uint32_t image_stride;
+    uint32_t images_offset;
+    uint32_t region_size;
+
+    // Client to game
+    alignas(64) std::atomic<uint32_t> request;
+    std::atomic<uint32_t> command;
+    std::atomic<uint32_t> server_waiting;
+    std::atomic<uint32_t> client_pid;      // 0 until a client attaches
+
+    // Game to client
+    alignas(64) std::atomic<uint32_t> response;
+    std::atomic<uint32_t> client_waiting;
+};
+
+// One side of the bridge; the game is the server, bridge_client the client
+class Bridge
+{
+private:
+    static const int SPIN_COUNT        = 20000;   // checks before sleeping, a few tens of microseconds
+    static const int PEER_CHECK_MS     = 100;     // how often a sleeping server looks for its client
+
+    unsigned char *m_region = NULL;
+    size_t m_region_size    = 0;
+    BridgeHeader *m_header  = NULL;
+    char m_name[64]         = "";
+    bool m_is_server        = false;
+    uint32_t m_last_seen    = 0;   // last request (server) or response (client) handled
+
+    // Returns false, without a change, if `peer_pid` is given and that
+    // process has exited
+    static bool wait_for_change(std::atomic<uint32_t> &counter, uint32_t seen, std::atomic<uint32_t> &waiting,
+                                const std::atomic<uint32_t> *peer_pid = NULL);
+    static void signal(std::atomic<uint32_t> &counter, std::atomic<uint32_t> &waiting);
+
+public:
+    // ––––– METHODS ––––– //
+    ~Bridge();
+
+    // Creates the region `name` (a shared-memory object name such as
+    // "/lander"), replacing any left behind by an earlier run
+    bool create(const char *name, int env_count, int observation_size, int action_size, int image_size = 0);
+
+    // Attaches to a region the game created
+    bool open(const char *name);
+    void close();
+
+    // ––––– SERVER ––––– //
+    // Blocks until the client sends a command and returns it, or returns
+    // BRIDGE_DISCONNECT once the client's process has exited
+    BridgeCommand wait_for_request();
+    void respond();
+
+    // ––––– CLIENT ––––– //
+    // Sends a command and blocks until the game has run it
+    void send(BridgeCommand command);
+
+    // ––––– GETTERS ––––– //
+    bool const is_open()              const { return m_header != NULL;                  };
+    int  const get_env_count()        const { return (int) m_header->env_count;        };
+    int  const get_observation_size() const { return (int) m_header->observation_size; };
+    int  const get_action_size()      const { return (int) m_header->action_size;      };
+    int  const get_image_size()       const { return (int) m_header->image_size;       };
+    int  const get_image_stride()     const { return (int) m_header->image_stride;     };
+
+    float   *get_observations() const { return (float *)   (m_region + m_header->observations_offset); };
+    float   *get_actions()      const { return (float *)   (m_region + m_header->actions_offset);      };
+    float   *get_rewards()      const { return (float *)   (m_region + m_header->rewards_offset);      };
+    uint8_t *get_dones()        const { return (uint8_t *) (m_region + m_header->dones_offset);        };
+    uint8_t *get_images()       const { return (uint8_t *) (m_region + m_header->images_offset);       };
+};
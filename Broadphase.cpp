@@ -0,0 +1,162 @@
+#define GL_SILENCE_DEPRECATION
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <algorithm>
+#include <cmath>
+#include <SDL.h>
+#include <SDL_opengl.h>
+#include "glm/mat4x4.hpp"
+#include "ShaderProgram.h"
+#include "Animation.h"
+#include "Entity.h"
+#include "Broadphase.h"
+
+Broadphase::Broadphase(float cell_size)
+{
+    m_cell_size     = cell_size;
+    m_inv_cell_size = 1.0f / cell_size;
+}
+
+int Broadphase::cell_coordinate(float position) const
+{
+    return (int) std::floor(position * m_inv_cell_size);
+}
+
+uint64_t Broadphase::cell_key(int x, int y)
+{
+    return ((uint64_t) (uint32_t) x << 32) | (uint32_t) y;
+}
+
+// ––––– UPDATES ––––– //
+int Broadphase::insert(Entity *entity)
+{
+    glm::vec3 position = entity->get_position();
+    glm::vec2 half     = glm::vec2(entity->get_width(), entity->get_height()) * 0.5f;
+
+    Entry entry;
+    entry.entity     = entity;
+    entry.min        = glm::vec2(position.x, position.y) - half;
+    entry.max        = glm::vec2(position.x, position.y) + half;
+    entry.cell_min_x = cell_coordinate(entry.min.x);
+    entry.cell_min_y = cell_coordinate(entry.min.y);
+    entry.cell_max_x = cell_coordinate(entry.max.x);
+    entry.cell_max_y = cell_coordinate(entry.max.y);
+    entry.stamp      = 0;
+
+    int handle;
+    if (!m_free_entries.empty())
+    {
+        handle = m_free_entries.back();
+        m_free_entries.pop_back();
+        m_entries[handle] = entry;
+    }
+    else
+    {
+        handle = (int) m_entries.size();
+        m_entries.push_back(entry);
+    }
+
+    for (int y = entry.cell_min_y; y <= entry.cell_max_y; y++)
+    {
+        for (int x = entry.cell_min_x; x <= entry.cell_max_x; x++) m_cells[cell_key(x, y)].push_back(handle);
+    }
+
+    m_count++;
+    m_version++;
+    return handle;
+}
+
+void Broadphase::remove(int handle)
+{
+    Entry &entry = m_entries[handle];
+
+    for (int y = entry.cell_min_y; y <= entry.cell_max_y; y++)
+    {
+        for (int x = entry.cell_min_x; x <= entry.cell_max_x; x++)
+        {
+            auto cell = m_cells.find(cell_key(x, y));
+            if (cell == m_cells.end()) continue;
+
+            std::vector<int> &handles = cell->second;
+            auto found = std::find(handles.begin(), handles.end(), handle);
+            if (found != handles.end())
+            {
+                *found = handles.back();
+                handles.pop_back();
+            }
+
+            // Emptied cells go, so memory follows what is in the grid
+            if (handles.empty()) m_cells.erase(cell);
+        }
+    }
+
+    entry.entity = NULL;
+    m_free_entries.push_back(handle);
+    m_count--;
+    m_version++;
+}
+
+void Broadphase::clear()
+{
+    m_cells.clear();
+    m_entries.clear();
+    m_free_entries.clear();
+    m_count = 0;
+    m_version++;
+}
+
+// ––––– QUERIES ––––– //
+int Broadphase::query(glm::vec2 min, glm::vec2 max, Entity **out, int max_count)
+{
+    // A wrapped stamp could match an entry stamped 2^32 queries ago
+    if (++m_stamp == 0)
+    {
+        for (Entry &entry : m_entries) entry.stamp = 0;
+        m_stamp = 1;
+    }
+
+    int count = 0;
+    int cell_min_x = cell_coordinate(min.x), cell_max_x = cell_coordinate(max.x);
+    int cell_min_y = cell_coordinate(min.y), cell_max_y = cell_coordinate(max.y);
+
+    for (int y = cell_min_y; y <= cell_max_y; y++)
+    {
+        for (int x = cell_min_x; x <= cell_max_x; x++)
+        {
+            auto cell = m_cells.find(cell_key(x, y));
+            if (cell == m_cells.end()) continue;
+
+            for (int handle : cell->second)
+            {
+                Entry &entry = m_entries[handle];
+                if (entry.stamp == m_stamp) continue;
+                entry.stamp = m_stamp;
+
+                if (entry.max.x < min.x || entry.min.x > max.x || entry.max.y < min.y || entry.min.y > max.y) continue;
+                if (count == max_count) return count;
+
+                out[count++] = entry.entity;
+            }
+        }
+    }
+
+    return count;
+}
+
+void Broadphase::get_entries(Entity **out, glm::vec2 *min, glm::vec2 *max) const
+{
+    int count = 0;
+    for (const Entry &entry : m_entries)
+    {
+        if (entry.entity == NULL) continue;
+
+        out[count] = entry.entity;
+        min[count] = entry.min;
+        max[count] = entry.max;
+        count++;
+    }
+}
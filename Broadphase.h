@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "glm/vec2.hpp"
+
+class Entity;
+
+/**
+ * Uniform grid over the level for "what is near this rectangle" questions:
+ * which platforms the player might touch this tick, which sprites the camera
+ * can see.
+ *
+ * Each entity is listed in every cell its box overlaps. Only occupied cells
+ * exist (they live in a hash map keyed by cell coordinates), so the grid
+ * costs memory in proportion to what is in it, not to how wide the level is.
+ * A query visits the cells under its rectangle and stamps each entity it
+ * reports, so one listed in several of those cells comes back once.
+ *
+ * Boxes are taken from the entity's position, width and height when it is
+ * inserted; an entity that moves has to be removed and inserted again.
+ */
+class Broadphase
+{
+private:
+    struct Entry
+    {
+        Entity *entity;
+        glm::vec2 min;
+        glm::vec2 max;
+        int cell_min_x, cell_min_y, cell_max_x, cell_max_y;
+        unsigned int stamp;
+    };
+
+    float m_cell_size;
+    float m_inv_cell_size;
+    std::unordered_map<uint64_t, std::vector<int>> m_cells;
+    std::vector<Entry> m_entries;
+    std::vector<int> m_free_entries;
+    int m_count         = 0;
+    unsigned int m_stamp = 0;
+    unsigned int m_version = 0;   // bumped by every change, for copies that need to know they are stale
+
+    int cell_coordinate(float position) const;
+    static uint64_t cell_key(int x, int y);
+
+public:
+    // ––––– METHODS ––––– //
+    explicit Broadphase(float cell_size);
+
+    // Returns a handle for remove()
+    int insert(Entity *entity);
+    void remove(int handle);
+    void clear();
+
+    // Writes up to `max_count` entities whose boxes overlap [min, max] and
+    // returns how many it wrote; any beyond that are left out
+    int query(glm::vec2 min, glm::vec2 max, Entity **out, int max_count);
+
+    // Writes every entity and the box it was inserted with; each array needs
+    // room for get_count()
+    void get_entries(Entity **out, glm::vec2 *min, glm::vec2 *max) const;
+
+    // ––––– GETTERS ––––– //
+    int          const get_count()      const { return m_count;               };
+    int          const get_cell_count() const { return (int) m_cells.size();  };
+    float        const get_cell_size()  const { return m_cell_size;           };
+    unsigned int const get_version()    const { return m_version;             };
+};
@@ -0,0 +1,52 @@
+#include <cmath>
+#include "glm/mat4x4.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "Camera.h"
+
+Camera::Camera(glm::vec2 half_size, float follow_rate)
+{
+    m_position    = glm::vec2(0.0f);
+    m_half_size   = half_size;
+    m_bounds_min  = -half_size;
+    m_bounds_max  = half_size;
+    m_follow_rate = follow_rate;
+}
+
+void Camera::set_bounds(glm::vec2 min, glm::vec2 max)
+{
+    m_bounds_min = min;
+    m_bounds_max = max;
+    m_position   = clamp_to_bounds(m_position);
+}
+
+glm::vec2 Camera::clamp_to_bounds(glm::vec2 position) const
+{
+    glm::vec2 lowest  = m_bounds_min + m_half_size;
+    glm::vec2 highest = m_bounds_max - m_half_size;
+
+    // A level narrower (or shorter) than the view sits in the middle of it
+    position.x = lowest.x > highest.x ? (m_bounds_min.x + m_bounds_max.x) * 0.5f
+                                      : std::fmin(std::fmax(position.x, lowest.x), highest.x);
+    position.y = lowest.y > highest.y ? (m_bounds_min.y + m_bounds_max.y) * 0.5f
+                                      : std::fmin(std::fmax(position.y, lowest.y), highest.y);
+
+    return position;
+}
+
+void Camera::snap_to(glm::vec2 target)
+{
+    m_position = clamp_to_bounds(target);
+}
+
+void Camera::follow(glm::vec2 target, float delta_time)
+{
+    // Exponential easing: the same fraction of the gap closes every second,
+    // whatever the tick length
+    float blend = 1.0f - std::exp(-m_follow_rate * delta_time);
+    m_position  = clamp_to_bounds(m_position + (target - m_position) * blend);
+}
+
+glm::mat4 const Camera::get_view_matrix() const
+{
+    return glm::translate(glm::mat4(1.0f), glm::vec3(-m_position.x, -m_position.y, 0.0f));
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "glm/mat4x4.hpp"
+
+/**
+ * Follows a target around the level and says what part of it is on screen.
+ *
+ * The camera eases towards its target rather than snapping, and is kept
+ * inside the level bounds so the view never shows past the edge of the
+ * level; a level smaller than the view is centred instead. The view matrix
+ * is just the inverse of the camera's translation, so the projection stays
+ * the same fixed rectangle centred on the camera.
+ */
+class Camera
+{
+private:
+    glm::vec2 m_position;
+    glm::vec2 m_half_size;
+    glm::vec2 m_bounds_min;
+    glm::vec2 m_bounds_max;
+    float m_follow_rate;   // per second; higher catches up faster
+
+    glm::vec2 clamp_to_bounds(glm::vec2 position) const;
+
+public:
+    // ––––– METHODS ––––– //
+    Camera(glm::vec2 half_size, float follow_rate);
+
+    void set_bounds(glm::vec2 min, glm::vec2 max);
+    void snap_to(glm::vec2 target);
+    void follow(glm::vec2 target, float delta_time);
+
+    // ––––– GETTERS ––––– //
+    glm::vec2 const get_position() const { return m_position;               };
+    glm::vec2 const get_min()      const { return m_position - m_half_size; };
+    glm::vec2 const get_max()      const { return m_position + m_half_size; };
+    glm::mat4 const get_view_matrix() const;
+};
@@ -0,0 +1,365 @@
+#define GL_SILENCE_DEPRECATION
+
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include "Capture.h"
+
+#ifdef _WINDOWS
+#include <direct.h>
+#define make_directory(path) _mkdir(path)
+#else
+#define make_directory(path) mkdir(path, 0755)
+#endif
+
+#define LOG(argument) std::cout << argument << '\n'
+
+const int CAPTURE_BYTES_PER_PIXEL = 4;   // read back as RGBA, the fast path everywhere
+
+// GL rows run bottom to top; every output wants them top down, without alpha
+static void to_upright_rgb(const unsigned char *pixels, int width, int height, unsigned char *rgb)
+{
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char *in = pixels + (size_t) (height - 1 - y) * width * CAPTURE_BYTES_PER_PIXEL;
+        unsigned char *out      = rgb + (size_t) y * width * 3;
+
+        for (int x = 0; x < width; x++, in += CAPTURE_BYTES_PER_PIXEL, out += 3)
+        {
+            out[0] = in[0];
+            out[1] = in[1];
+            out[2] = in[2];
+        }
+    }
+}
+
+FrameCapture::~FrameCapture()
+{
+    // GL objects need the context, so only the writer is stopped here;
+    // shutdown() is the clean exit
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_is_running = false;
+    }
+    m_wakeup.notify_one();
+    if (m_writer.joinable()) m_writer.join();
+    if (m_video != NULL) fclose(m_video);
+}
+
+bool FrameCapture::initialise(int width, int height, bool offscreen, CaptureFormat format, const char *path)
+{
+    m_width  = width;
+    m_height = height;
+
+    if (offscreen)
+    {
+        glGenFramebuffers(1, &m_framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+
+        glGenRenderbuffers(1, &m_colour_buffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, m_colour_buffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colour_buffer);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            LOG("Unable to create the offscreen framebuffer.");
+            shutdown();
+            return false;
+        }
+    }
+
+    if (format == CAPTURE_NONE) return true;
+
+    if (format == CAPTURE_RAW_VIDEO)
+    {
+        m_video = fopen(path, "wb");
+        if (m_video == NULL)
+        {
+            LOG("Unable to open " << path << " for the capture.");
+            shutdown();
+            return false;
+        }
+    }
+    else
+    {
+        make_directory(path);   // already existing is fine
+    }
+
+    m_format = format;
+    m_path   = path;
+
+    size_t frame_size = (size_t) width * height * CAPTURE_BYTES_PER_PIXEL;
+
+    glGenBuffers(PIXEL_BUFFER_COUNT, m_pixel_buffers);
+    for (int i = 0; i < PIXEL_BUFFER_COUNT; i++)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixel_buffers[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr) frame_size, NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_slots.assign(SLOT_COUNT, std::vector<unsigned char>(frame_size));
+    for (int i = 0; i < SLOT_COUNT; i++) m_free_slots.push_back(i);
+
+    m_is_running = true;
+    m_writer = std::thread(&FrameCapture::write_loop, this);
+
+    return true;
+}
+
+void FrameCapture::shutdown()
+{
+    // The last frame read back has not been collected yet
+    if (is_capturing() && m_frames_read > 0) collect(m_frames_read - 1);
+
+    if (m_writer.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_is_running = false;
+        }
+        m_wakeup.notify_one();
+        m_writer.join();
+    }
+
+    if (is_capturing())
+    {
+        LOG("Captured " << m_frames_read << " frames to " << m_path << " (" << m_stalls
+            << " waits on the writer).");
+    }
+
+    if (m_video != NULL) fclose(m_video);
+    m_video = NULL;
+
+    if (m_pixel_buffers[0] != 0) glDeleteBuffers(PIXEL_BUFFER_COUNT, m_pixel_buffers);
+    if (m_colour_buffer != 0) glDeleteRenderbuffers(1, &m_colour_buffer);
+    if (m_framebuffer != 0)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &m_framebuffer);
+    }
+
+    m_pixel_buffers[0] = m_pixel_buffers[1] = 0;
+    m_colour_buffer = 0;
+    m_framebuffer   = 0;
+    m_format        = CAPTURE_NONE;
+    m_slots.clear();
+    m_free_slots.clear();
+}
+
+// ––––– GL THREAD ––––– //
+void FrameCapture::begin_frame()
+{
+    if (m_framebuffer != 0) glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+}
+
+void FrameCapture::end_frame()
+{
+    if (!is_capturing()) return;
+
+    // Only queues the copy; with a pack buffer bound, glReadPixels returns at once
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixel_buffers[m_frames_read % PIXEL_BUFFER_COUNT]);
+    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, (void *) 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_frames_read++;
+
+    // The frame before has had a whole frame for its copy to land
+    if (m_frames_read > 1) collect(m_frames_read - 2);
+}
+
+void FrameCapture::read_frame(std::vector<unsigned char> &rgb)
+{
+    m_readback.resize((size_t) m_width * m_height * CAPTURE_BYTES_PER_PIXEL);
+    rgb.resize((size_t) m_width * m_height * 3);
+
+    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, m_readback.data());
+    to_upright_rgb(m_readback.data(), m_width, m_height, rgb.data());
+}
+
+void FrameCapture::collect(int frame_number)
+{
+    int slot;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_free_slots.empty()) m_stalls++;
+        m_slot_freed.wait(lock, [this] { return !m_free_slots.empty(); });
+
+        slot = m_free_slots.front();
+        m_free_slots.pop_front();
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixel_buffers[frame_number % PIXEL_BUFFER_COUNT]);
+    const unsigned char *pixels = (const unsigned char *) glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+
+    if (pixels != NULL)
+    {
+        memcpy(m_slots[slot].data(), pixels, m_slots[slot].size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (pixels != NULL) m_pending.push_back({ slot, frame_number });
+        else                m_free_slots.push_back(slot);
+    }
+    if (pixels != NULL) m_wakeup.notify_one();
+    else                LOG("Unable to map frame " << frame_number << "; it is missing from the capture.");
+}
+
+// ––––– WRITER THREAD ––––– //
+void FrameCapture::write_loop()
+{
+    while (true)
+    {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeup.wait(lock, [this] { return !m_is_running || !m_pending.empty(); });
+
+            // Everything queued is written before the thread stops
+            if (m_pending.empty()) return;
+
+            frame = m_pending.front();
+            m_pending.pop_front();
+        }
+
+        if (!write_frame(m_slots[frame.slot].data(), frame.number))
+        {
+            LOG("Unable to write frame " << frame.number << " of the capture.");
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_free_slots.push_back(frame.slot);
+        }
+        m_slot_freed.notify_one();
+    }
+}
+
+bool FrameCapture::write_frame(const unsigned char *pixels, int frame_number)
+{
+    m_upright.resize((size_t) m_width * m_height * 3);
+    to_upright_rgb(pixels, m_width, m_height, m_upright.data());
+
+    if (m_format == CAPTURE_RAW_VIDEO)
+    {
+        return fwrite(m_upright.data(), 1, m_upright.size(), m_video) == m_upright.size();
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "/frame_%06d.png", frame_number);
+    return write_png((m_path + name).c_str(), m_upright.data(), m_width, m_height, 3);
+}
+
+// ––––– PNG ––––– //
+static uint32_t png_crc(const unsigned char *data, size_t size, uint32_t crc)
+{
+    struct CrcTable
+    {
+        uint32_t entries[256];
+
+        CrcTable()
+        {
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t value = i;
+                for (int bit = 0; bit < 8; bit++) value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+                entries[i] = value;
+            }
+        }
+    };
+    static const CrcTable table;   // built once, thread-safely, on first use
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void put_be32(std::vector<unsigned char> &out, uint32_t value)
+{
+    unsigned char bytes[4] = { (unsigned char) (value >> 24), (unsigned char) (value >> 16),
+                               (unsigned char) (value >> 8),  (unsigned char) value };
+    out.insert(out.end(), bytes, bytes + 4);
+}
+
+static bool write_chunk(FILE *file, const char *type, const unsigned char *data, size_t size)
+{
+    std::vector<unsigned char> header;
+    put_be32(header, (uint32_t) size);
+    header.insert(header.end(), type, type + 4);
+
+    std::vector<unsigned char> footer;
+    put_be32(footer, png_crc(data, size, png_crc(&header[4], 4, 0)));
+
+    return fwrite(header.data(), 1, header.size(), file) == header.size() &&
+           (size == 0 || fwrite(data, 1, size, file) == size) &&
+           fwrite(footer.data(), 1, footer.size(), file) == footer.size();
+}
+
+bool write_png(const char *filepath, const unsigned char *pixels, int width, int height, int components)
+{
+    const size_t MAX_STORED_BLOCK = 65535;
+    const unsigned char SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+    // Every row gets filter type 0 (none) in front of it
+    size_t row_size = (size_t) width * components;
+    std::vector<unsigned char> rows;
+    rows.reserve((row_size + 1) * height);
+    for (int y = 0; y < height; y++)
+    {
+        rows.push_back(0);
+        rows.insert(rows.end(), pixels + y * row_size, pixels + (y + 1) * row_size);
+    }
+
+    // zlib stream of stored deflate blocks, then the Adler-32 of the rows
+    std::vector<unsigned char> compressed;
+    compressed.reserve(rows.size() + rows.size() / MAX_STORED_BLOCK * 5 + 16);
+    compressed.push_back(0x78);
+    compressed.push_back(0x01);
+
+    uint32_t a = 1, b = 0;
+    size_t offset = 0;
+    do
+    {
+        size_t size = std::min(MAX_STORED_BLOCK, rows.size() - offset);
+        bool is_last = offset + size == rows.size();
+
+        compressed.push_back(is_last ? 1 : 0);
+        compressed.push_back((unsigned char) size);
+        compressed.push_back((unsigned char) (size >> 8));
+        compressed.push_back((unsigned char) ~size);
+        compressed.push_back((unsigned char) (~size >> 8));
+        compressed.insert(compressed.end(), rows.begin() + offset, rows.begin() + offset + size);
+
+        for (size_t i = offset; i < offset + size; i++)
+        {
+            a = (a + rows[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        offset += size;
+    } while (offset < rows.size());
+    put_be32(compressed, (b << 16) | a);
+
+    std::vector<unsigned char> header;
+    put_be32(header, (uint32_t) width);
+    put_be32(header, (uint32_t) height);
+    header.push_back(8);                          // bits per channel
+    header.push_back(components == 4 ? 6 : 2);    // RGBA or RGB
+    header.push_back(0);                          // deflate
+    header.push_back(0);                          // adaptive filtering
+    header.push_back(0);                          // not interlaced
+
+    FILE *file = fopen(filepath, "wb");
+    if (file == NULL) return false;
+
+    bool is_written = fwrite(SIGNATURE, 1, sizeof(SIGNATURE), file) == sizeof(SIGNATURE) &&
+                      write_chunk(file, "IHDR", header.data(), header.size()) &&
+                      write_chunk(file, "IDAT", compressed.data(), compressed.size()) &&
+                      write_chunk(file, "IEND", NULL, 0);
+
+    return fclose(file) == 0 && is_written;
+}
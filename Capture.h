@@ -0,0 +1,100 @@
+#pragma once
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum CaptureFormat { CAPTURE_NONE, CAPTURE_RAW_VIDEO, CAPTURE_PNG_SEQUENCE };
+
+/**
+ * Offscreen rendering and frame capture, for recording footage and golden
+ * images on machines without a display or a GPU.
+ *
+ *  - Offscreen runs draw into a framebuffer object rather than the window.
+ *    With SDL's "offscreen" video driver the context itself comes from EGL
+ *    without a surface, which Mesa's llvmpipe provides on CPU-only servers.
+ *  - Each captured frame is read back with glReadPixels into one of two
+ *    pixel-pack buffers. That only queues the copy; the buffer is mapped one
+ *    frame later, once the copy is long done, so the GL thread never waits
+ *    on the GPU.
+ *  - The mapped frame is copied into a free slot for a writer thread, which
+ *    flips it upright and writes it as raw RGB24 video or one PNG per frame.
+ *    With every slot busy the GL thread waits for the writer: a capture never
+ *    drops frames.
+ */
+class FrameCapture
+{
+private:
+    struct Frame
+    {
+        int slot;
+        int number;
+    };
+
+    static const int PIXEL_BUFFER_COUNT = 2;
+    static const int SLOT_COUNT         = 4;
+
+    CaptureFormat m_format = CAPTURE_NONE;
+    std::string m_path;
+    int m_width  = 0;
+    int m_height = 0;
+
+    // ––––– GL THREAD ––––– //
+    GLuint m_framebuffer   = 0;
+    GLuint m_colour_buffer = 0;
+    GLuint m_pixel_buffers[PIXEL_BUFFER_COUNT] = { 0 };
+    int m_frames_read = 0;   // frames handed to glReadPixels so far
+    int m_stalls      = 0;   // times the writer had no free slot
+
+    // ––––– WRITER THREAD ––––– //
+    std::thread m_writer;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::condition_variable m_slot_freed;
+    std::vector<std::vector<unsigned char>> m_slots;
+    std::deque<int> m_free_slots;
+    std::deque<Frame> m_pending;
+    bool m_is_running = false;
+    FILE *m_video     = NULL;
+    std::vector<unsigned char> m_upright;
+    std::vector<unsigned char> m_readback;   // read_frame() only
+
+    void collect(int frame_number);
+    void write_loop();
+    bool write_frame(const unsigned char *pixels, int frame_number);
+
+public:
+    // ––––– METHODS ––––– //
+    ~FrameCapture();
+
+    // Either part can be used alone: offscreen without a format just renders
+    // headless, a format without offscreen records the window
+    bool initialise(int width, int height, bool offscreen, CaptureFormat format, const char *path);
+    void shutdown();
+
+    void begin_frame();
+    void end_frame();
+
+    // Reads the current frame straight away, waiting on the GPU, as top-down
+    // RGB. For one-off captures such as golden images, not for recording.
+    void read_frame(std::vector<unsigned char> &rgb);
+
+    // ––––– GETTERS ––––– //
+    bool const is_offscreen() const { return m_framebuffer != 0;          };
+    bool const is_capturing() const { return m_format != CAPTURE_NONE;    };
+    int  const get_frame_count() const { return m_frames_read;            };
+};
+
+// ––––– PNG ––––– //
+// Writes 8-bit RGB (3 components) or RGBA (4), rows top to bottom. The image
+// data is stored, not deflated, so files are large but cost nothing to encode.
+bool write_png(const char *filepath, const unsigned char *pixels, int width, int height, int components);
@@ -0,0 +1,238 @@
+#include <sys/stat.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "stb_image.h"
+#include "Arena.h"
+#include "Hash.h"
+#include "Texture.h"
+#include "TextureCompression.h"
+#include "CollisionMask.h"
+
+#define LOG(argument) std::cout << argument << '\n'
+
+// ––––– FILES ––––– //
+// The .mask file and the cache copy are both keyed on the PNG's contents,
+// like a .bc7 or a cached texture
+struct CollisionMaskHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t source_hash;
+    int32_t width;
+    int32_t height;
+};
+
+static const char COLLISION_MASK_MAGIC[4]   = { 'L', 'L', 'M', 'K' };
+static const uint32_t COLLISION_MASK_VERSION = 1;
+
+static int words_for(int width)
+{
+    return (width + 63) / 64;
+}
+
+std::string collision_mask_path(const char *filepath)
+{
+    std::string path = filepath;
+    size_t extension = path.find_last_of('.');
+    if (extension != std::string::npos && path.find('/', extension) == std::string::npos) path.erase(extension);
+    return path + ".mask";
+}
+
+static std::string cache_path(const char *filepath)
+{
+    char name[48];
+    snprintf(name, sizeof(name), "mask_%016llx.cache",
+             (unsigned long long) hash_bytes(filepath, strlen(filepath)));
+    return get_texture_cache_directory() + name;
+}
+
+bool write_collision_mask_image(const char *filepath, const CollisionMaskImage &image, uint64_t source_hash)
+{
+    CollisionMaskHeader header;
+    memcpy(header.magic, COLLISION_MASK_MAGIC, sizeof(header.magic));
+    header.version     = COLLISION_MASK_VERSION;
+    header.source_hash = source_hash;
+    header.width       = image.width;
+    header.height      = image.height;
+
+    return replace_file(filepath, &header, sizeof(header), image.words.data(),
+                        image.words.size() * sizeof(uint64_t));
+}
+
+bool read_collision_mask_image(const char *filepath, uint64_t source_hash, CollisionMaskImage &image)
+{
+    std::ifstream infile(filepath, std::ios::binary);
+    if (infile.fail()) return false;
+
+    CollisionMaskHeader header;
+    if (!infile.read((char *) &header, sizeof(header))) return false;
+
+    if (memcmp(header.magic, COLLISION_MASK_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != COLLISION_MASK_VERSION ||
+        header.source_hash != source_hash ||
+        header.width <= 0 || header.height <= 0)
+    {
+        return false;
+    }
+
+    // The words are the rest of the file; a corrupt size must not turn into
+    // a huge allocation
+    std::streampos start = infile.tellg();
+    infile.seekg(0, std::ios::end);
+    size_t remaining = (size_t) (infile.tellg() - start);
+    infile.seekg(start);
+    if (((size_t) header.width + 63) / 64 * header.height > remaining / sizeof(uint64_t)) return false;
+
+    image.width         = header.width;
+    image.height        = header.height;
+    image.words_per_row = words_for(header.width);
+    image.words.resize((size_t) image.words_per_row * image.height);
+
+    return (bool) infile.read((char *) image.words.data(), image.words.size() * sizeof(uint64_t));
+}
+
+// ––––– IMAGES ––––– //
+void build_collision_mask_image(const unsigned char *rgba, int width, int height, CollisionMaskImage &image)
+{
+    image.width         = width;
+    image.height        = height;
+    image.words_per_row = words_for(width);
+    image.words.assign((size_t) image.words_per_row * height, 0);
+
+    for (int y = 0; y < height; y++)
+    {
+        uint64_t *row = &image.words[(size_t) y * image.words_per_row];
+        const unsigned char *pixel = rgba + (size_t) y * width * 4;
+
+        for (int x = 0; x < width; x++)
+        {
+            if (pixel[x * 4 + 3] >= COLLISION_ALPHA_THRESHOLD) row[x >> 6] |= 1ULL << (x & 63);
+        }
+    }
+}
+
+bool load_collision_mask_image(const char *filepath, CollisionMaskImage &image)
+{
+    // Both the .mask file and the cache are keyed on the PNG's contents
+    uint64_t source_hash;
+    if (!hash_file(filepath, source_hash)) return false;
+
+    // Built offline by asset_tool
+    struct stat mask_file;
+    std::string mask_path = collision_mask_path(filepath);
+    if (stat(mask_path.c_str(), &mask_file) == 0)
+    {
+        if (read_collision_mask_image(mask_path.c_str(), source_hash, image)) return true;
+        LOG("Ignoring out-of-date " << mask_path << "; rebuild it with asset_tool.");
+    }
+
+    bool use_cache = !get_texture_cache_directory().empty();
+    std::string cached = use_cache ? cache_path(filepath) : std::string();
+    if (use_cache && read_collision_mask_image(cached.c_str(), source_hash, image)) return true;
+
+    int width, height, number_of_components;
+    unsigned char *decoded = stbi_load(filepath, &width, &height, &number_of_components, STBI_rgb_alpha);
+    if (decoded == NULL) return false;
+
+    build_collision_mask_image(decoded, width, height, image);
+    stbi_image_free(decoded);
+
+    if (use_cache) write_collision_mask_image(cached.c_str(), image, source_hash);
+    return true;
+}
+
+// ––––– MASKS ––––– //
+static void mask_size(float world_width, float world_height, int &width, int &height)
+{
+    width  = std::max((int) std::lround(world_width  * COLLISION_PIXELS_PER_UNIT), 1);
+    height = std::max((int) std::lround(world_height * COLLISION_PIXELS_PER_UNIT), 1);
+}
+
+int collision_mask_words(float world_width, float world_height)
+{
+    int width, height;
+    mask_size(world_width, world_height, width, height);
+    return words_for(width) * height;
+}
+
+void build_collision_mask(const CollisionMaskImage &image, float u, float v, float du, float dv, float world_width,
+                          float world_height, uint64_t *words, CollisionMask &mask)
+{
+    mask_size(world_width, world_height, mask.width, mask.height);
+    mask.words_per_row = words_for(mask.width);
+    mask.words         = words;
+    std::fill(words, words + (size_t) mask.words_per_row * mask.height, 0);
+
+    // Nearest source pixel to the centre of each mask pixel
+    for (int y = 0; y < mask.height; y++)
+    {
+        int source_y = std::min((int) ((v + (y + 0.5f) / mask.height * dv) * image.height), image.height - 1);
+        const uint64_t *source_row = &image.words[(size_t) source_y * image.words_per_row];
+        uint64_t *row = words + (size_t) y * mask.words_per_row;
+
+        for (int x = 0; x < mask.width; x++)
+        {
+            int source_x = std::min((int) ((u + (x + 0.5f) / mask.width * du) * image.width), image.width - 1);
+            if ((source_row[source_x >> 6] >> (source_x & 63)) & 1) row[x >> 6] |= 1ULL << (x & 63);
+        }
+    }
+}
+
+CollisionMask *create_collision_mask(Arena &arena, const CollisionMaskImage &image, float u, float v, float du,
+                                     float dv, float world_width, float world_height)
+{
+    CollisionMask *mask = arena.create<CollisionMask>();
+    uint64_t *words     = arena.allocate_array<uint64_t>(collision_mask_words(world_width, world_height));
+    if (mask == NULL || words == NULL) return NULL;
+
+    build_collision_mask(image, u, v, du, dv, world_width, world_height, words, *mask);
+    return mask;
+}
+
+// 64 bits of a row starting at bit `offset`, zeros past its end
+static inline uint64_t read_bits(const uint64_t *row, int words_per_row, int offset)
+{
+    int word  = offset >> 6;
+    int shift = offset & 63;
+
+    uint64_t bits = row[word] >> shift;
+    if (shift != 0 && word + 1 < words_per_row) bits |= row[word + 1] << (64 - shift);
+    return bits;
+}
+
+bool collision_masks_overlap(const CollisionMask &a, float a_x, float a_y, const CollisionMask &b, float b_x,
+                             float b_y)
+{
+    // Top-left corners on the shared pixel grid, y growing downwards like the rows
+    int a_left = (int) std::lround(a_x * COLLISION_PIXELS_PER_UNIT) - a.width / 2;
+    int a_top  = (int) std::lround(-a_y * COLLISION_PIXELS_PER_UNIT) - a.height / 2;
+    int b_left = (int) std::lround(b_x * COLLISION_PIXELS_PER_UNIT) - b.width / 2;
+    int b_top  = (int) std::lround(-b_y * COLLISION_PIXELS_PER_UNIT) - b.height / 2;
+
+    int left   = std::max(a_left, b_left), right  = std::min(a_left + a.width,  b_left + b.width);
+    int top    = std::max(a_top,  b_top),  bottom = std::min(a_top  + a.height, b_top  + b.height);
+    if (left >= right || top >= bottom) return false;
+
+    for (int y = top; y < bottom; y++)
+    {
+        const uint64_t *a_row = a.words + (size_t) (y - a_top) * a.words_per_row;
+        const uint64_t *b_row = b.words + (size_t) (y - b_top) * b.words_per_row;
+
+        // Both rows read from the same column of the overlap, 64 pixels at a time
+        for (int x = left; x < right; x += 64)
+        {
+            uint64_t bits = read_bits(a_row, a.words_per_row, x - a_left) &
+                            read_bits(b_row, b.words_per_row, x - b_left);
+
+            int span = right - x;
+            if (span < 64) bits &= (1ULL << span) - 1;
+            if (bits != 0) return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Arena;
+
+/**
+ * One bit per pixel of a sprite: set where the sprite is at least half
+ * opaque. Rows run top to bottom, each packed into 64-bit words with the
+ * leftmost pixel in the lowest bit.
+ *
+ * A CollisionMaskImage is the whole texture at its source resolution, built
+ * offline by tools/asset_tool and stored next to its PNG as a .mask file:
+ *
+ *     header { "LLMK", version, source hash, width, height }
+ *     words for row 0, row 1, ... back to back
+ *
+ * Without an up-to-date .mask file the image is built from the PNG's alpha at
+ * load and kept in the texture cache directory instead.
+ *
+ * A CollisionMask is what entities collide with: part of an image resampled
+ * to COLLISION_PIXELS_PER_UNIT at the size the sprite is drawn, so two masks
+ * line up pixel for pixel whatever their textures, and comparing them is a
+ * run of shifted word ANDs. Its words belong to whoever built it, usually the
+ * level arena.
+ */
+const float COLLISION_PIXELS_PER_UNIT = 32.0f;
+const int   COLLISION_ALPHA_THRESHOLD = 128;
+
+struct CollisionMaskImage
+{
+    int width  = 0;
+    int height = 0;
+    int words_per_row = 0;
+    std::vector<uint64_t> words;
+};
+
+struct CollisionMask
+{
+    int width  = 0;
+    int height = 0;
+    int words_per_row = 0;
+    uint64_t *words   = NULL;
+};
+
+// ––––– IMAGES ––––– //
+void build_collision_mask_image(const unsigned char *rgba, int width, int height, CollisionMaskImage &image);
+
+// The .mask file next to the PNG if it is up to date, then the texture cache,
+// then the PNG itself
+bool load_collision_mask_image(const char *filepath, CollisionMaskImage &image);
+
+std::string collision_mask_path(const char *filepath);
+bool write_collision_mask_image(const char *filepath, const CollisionMaskImage &image, uint64_t source_hash);
+bool read_collision_mask_image(const char *filepath, uint64_t source_hash, CollisionMaskImage &image);
+
+// ––––– MASKS ––––– //
+// Words needed by a mask for a sprite drawn world_width x world_height
+int collision_mask_words(float world_width, float world_height);
+
+// Resamples the UV rectangle [u, u + du] x [v, v + dv] of `image` (v from the
+// top) into `words`, which needs collision_mask_words() of room
+void build_collision_mask(const CollisionMaskImage &image, float u, float v, float du, float dv, float world_width,
+                          float world_height, uint64_t *words, CollisionMask &mask);
+
+// build_collision_mask() into the arena; NULL if it is full
+CollisionMask *create_collision_mask(Arena &arena, const CollisionMaskImage &image, float u, float v, float du,
+                                     float dv, float world_width, float world_height);
+
+// Whether any pixel is set in both masks, each centred on its position in
+// world units
+bool collision_masks_overlap(const CollisionMask &a, float a_x, float a_y, const CollisionMask &b, float b_x,
+                             float b_y);
@@ -12,7 +12,11 @@
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
+#include "Animation.h"
 #include "Entity.h"
+#include "Terrain.h"
+#include "CollisionMask.h"
+#include "RenderStats.h"
 
 Entity::Entity()
 {
@@ -20,6 +24,7 @@ Entity::Entity()
     m_position     = glm::vec3(0.0f);
     m_velocity     = glm::vec3(0.0f);
     m_acceleration = glm::vec3(0.0f);
+    m_current      = glm::vec3(0.0f);
     
     // ––––– TRANSLATION ––––– //
     m_movement = glm::vec3(0.0f);
@@ -29,27 +34,11 @@ Entity::Entity()
 
 Entity::~Entity()
 {
-    delete [] m_animation_up;
-    delete [] m_animation_down;
-    delete [] m_animation_left;
-    delete [] m_animation_right;
-    delete [] m_walking;
+    // Animation clips belong to the AnimationLibrary, so there is nothing to free
 }
 
-void Entity::draw_sprite_from_texture_atlas(ShaderProgram *program, GLuint texture_id, int index)
+void Entity::draw_sprite_from_texture_atlas(ShaderProgram *program, GLuint texture_id, const AnimationFrame &frame)
 {
-    float u_coord = (float) (index % m_animation_cols) / (float) m_animation_cols;
-    float v_coord = (float) (index / m_animation_cols) / (float) m_animation_rows;
-    
-    float width = 1.0f / (float) m_animation_cols;
-    float height = 1.0f / (float) m_animation_rows;
-    
-    float tex_coords[] =
-    {
-        u_coord, v_coord + height, u_coord + width, v_coord + height, u_coord + width, v_coord,
-        u_coord, v_coord + height, u_coord + width, v_coord, u_coord, v_coord
-    };
-    
     float vertices[] =
     {
         -0.5, -0.5, 0.5, -0.5,  0.5, 0.5,
@@ -61,17 +50,18 @@ void Entity::draw_sprite_from_texture_atlas(ShaderProgram *program, GLuint textu
     glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices);
     glEnableVertexAttribArray(program->positionAttribute);
     
-    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, tex_coords);
+    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, frame.tex_coords);
     glEnableVertexAttribArray(program->texCoordAttribute);
     
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    draw_arrays(GL_TRIANGLES, 0, 6);
     
     glDisableVertexAttribArray(program->positionAttribute);
     glDisableVertexAttribArray(program->texCoordAttribute);
 }
 
-void Entity::update(float delta_time, Entity *collidable_entities,
-                    int collidable_entity_count, bool& g_player_win, bool& g_player_lost)
+void Entity::update(float delta_time, Entity **collidable_entities,
+                    int collidable_entity_count, bool& g_player_win, bool& g_player_lost,
+                    const Terrain *terrain)
 {
     if (!m_is_active) return;
     
@@ -80,25 +70,35 @@ void Entity::update(float delta_time, Entity *collidable_entities,
     m_collided_left   = false;
     m_collided_right  = false;
     
+    // ––––– FUEL ––––– //
+    // Thrust burns fuel in proportion to how hard we push; an empty tank means no thrust
+    if (m_fuel_burn_rate > 0.0f && glm::length(m_movement) != 0)
+    {
+        if (m_fuel > 0.0f)
+        {
+            m_fuel -= glm::length(m_movement) * m_fuel_burn_rate * delta_time;
+            if (m_fuel < 0.0f) m_fuel = 0.0f;
+        }
+        else
+        {
+            m_movement = glm::vec3(0.0f);
+        }
+    }
+    
     // ––––– ANIMATION ––––– //
-    if (m_animation_indices != NULL)
+    if (m_animation_clip != NULL)
     {
         if (glm::length(m_movement) != 0)
         {
             m_animation_time += delta_time;
-            float frames_per_second = (float) 1 / SECONDS_PER_FRAME;
             
-            if (m_animation_time >= frames_per_second)
+            if (m_animation_time >= m_animation_clip->duration)
             {
-                m_animation_time = 0.0f;
-                m_animation_index++;
-                
-                if (m_animation_index >= m_animation_frames)
-                {
-                    m_animation_index = 0;
-                }
+                m_animation_time = fmod(m_animation_time, m_animation_clip->duration);
             }
         }
+        
+        m_animation_index = m_animation_clip->frame_at(m_animation_time);
     }
     
     // ––––– GRAVITY ––––– //
@@ -134,6 +134,10 @@ void Entity::update(float delta_time, Entity *collidable_entities,
         m_acceleration.y  = m_movement.y * m_speed;
     }
     
+    // ––––– WATER CURRENTS ––––– //
+    // Sampled from the level's flow field before each tick
+    m_acceleration += m_current;
+    
     m_movement = glm::vec3(0.0f, 0.0f, 0.0f);
     
     m_velocity   += m_acceleration * delta_time;
@@ -145,18 +149,20 @@ void Entity::update(float delta_time, Entity *collidable_entities,
     check_collision_x(collidable_entities, collidable_entity_count,
                       g_player_win, g_player_lost);
     
+    if (terrain != NULL) check_collision_terrain(terrain);
+    
     // ––––– TRANSFORMATIONS ––––– //
     m_model_matrix = glm::mat4(1.0f);
     m_model_matrix = glm::translate(m_model_matrix, m_position);
 }
 
-void const Entity::check_collision_y(Entity *collidable_entities, int collidable_entity_count,
+void const Entity::check_collision_y(Entity **collidable_entities, int collidable_entity_count,
                                      bool& g_player_win, bool& g_player_lost)
 {
     for (int i = 0; i < collidable_entity_count; i++)
     {
         // STEP 1: For every entity that our player can collide with...
-        Entity *collidable_entity = &collidable_entities[i];
+        Entity *collidable_entity = collidable_entities[i];
         
         if (check_collision(collidable_entity))
         {
@@ -175,7 +181,11 @@ void const Entity::check_collision_y(Entity *collidable_entities, int collidable
             float y_overlap = fabs(y_distance - (m_height / 2.0f) - (collidable_entity->m_height / 2.0f));
             
             // STEP 3: "Unclip" ourselves from the other entity, and zero our
-            //         vertical velocity.
+            //         vertical velocity. The hit comes from the pixel masks
+            //         but this moves by the whole boxes' overlap, so the
+            //         lander snaps out by the transparent margin. That is
+            //         accepted: every platform is a win or a loss, and
+            //         touching one ends the game or the episode.
             if (m_velocity.y > 0) {
                 m_position.y   -= y_overlap;
                 m_velocity.y    = 0;
@@ -189,12 +199,12 @@ void const Entity::check_collision_y(Entity *collidable_entities, int collidable
     }
 }
 
-void const Entity::check_collision_x(Entity *collidable_entities, int collidable_entity_count,
+void const Entity::check_collision_x(Entity **collidable_entities, int collidable_entity_count,
                                      bool& g_player_win, bool& g_player_lost)
 {
     for (int i = 0; i < collidable_entity_count; i++)
     {
-        Entity *collidable_entity = &collidable_entities[i];
+        Entity *collidable_entity = collidable_entities[i];
         
         if (check_collision(collidable_entity))
         {
@@ -206,6 +216,7 @@ void const Entity::check_collision_x(Entity *collidable_entities, int collidable
             {
                 g_player_win = true;
             }
+            // Unclipped by the boxes, as in check_collision_y()
             float x_distance = fabs(m_position.x - collidable_entity->m_position.x);
             float x_overlap = fabs(x_distance - (m_width / 2.0f) - (collidable_entity->m_width / 2.0f));
             if (m_velocity.x > 0) {
@@ -221,29 +232,58 @@ void const Entity::check_collision_x(Entity *collidable_entities, int collidable
     }
 }
 
-void Entity::render(ShaderProgram *program)
+void const Entity::check_collision_terrain(const Terrain *terrain)
 {
-    if (!m_is_active) return;
+    // Only the seabed under where the box ends up counts. It is solid all the
+    // way down, so anything below it is pushed back up onto it and it cannot
+    // be tunnelled through, however fast we fall; the ground under the whole
+    // sweep would lift a fast pass onto a crest it has already left.
+    float ground;
+    if (!terrain->get_ground(m_position.x - m_width / 2.0f, m_position.x + m_width / 2.0f, ground)) return;
+    
+    float bottom = m_position.y - m_height / 2.0f;
+    if (bottom < ground)
+    {
+        m_position.y += ground - bottom;
+        if (m_velocity.y < 0) m_velocity.y = 0;
+        m_collided_bottom = true;
+    }
+}
+
+SpriteSnapshot const Entity::get_snapshot() const
+{
+    SpriteSnapshot sprite;
+    sprite.model_matrix = m_model_matrix;
+    sprite.texture_id   = m_texture_id;
+    sprite.frame        = m_animation_clip != NULL ? &m_animation_clip->frames[m_animation_index] : NULL;
+    sprite.is_active    = m_is_active;
+    
+    return sprite;
+}
+
+void Entity::render_snapshot(ShaderProgram *program, const SpriteSnapshot &sprite)
+{
+    if (!sprite.is_active) return;
     
-    program->SetModelMatrix(m_model_matrix);
+    program->SetModelMatrix(sprite.model_matrix);
     
-    if (m_animation_indices != NULL)
+    if (sprite.frame != NULL)
     {
-        draw_sprite_from_texture_atlas(program, m_texture_id, m_animation_indices[m_animation_index]);
+        draw_sprite_from_texture_atlas(program, sprite.texture_id, *sprite.frame);
         return;
     }
     
     float vertices[]   = { -0.5, -0.5, 0.5, -0.5, 0.5, 0.5, -0.5, -0.5, 0.5, 0.5, -0.5, 0.5 };
     float tex_coords[] = {  0.0,  1.0, 1.0,  1.0, 1.0, 0.0,  0.0,  1.0, 1.0, 0.0,  0.0, 0.0 };
     
-    glBindTexture(GL_TEXTURE_2D, m_texture_id);
+    glBindTexture(GL_TEXTURE_2D, sprite.texture_id);
     
     glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices);
     glEnableVertexAttribArray(program->positionAttribute);
     glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, tex_coords);
     glEnableVertexAttribArray(program->texCoordAttribute);
     
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    draw_arrays(GL_TRIANGLES, 0, 6);
     
     glDisableVertexAttribArray(program->positionAttribute);
     glDisableVertexAttribArray(program->texCoordAttribute);
@@ -257,5 +297,19 @@ bool const Entity::check_collision(Entity *other) const
     float x_distance = fabs(m_position.x - other->m_position.x) - ((m_width  + other->m_width)  / 2.0f);
     float y_distance = fabs(m_position.y - other->m_position.y) - ((m_height + other->m_height) / 2.0f);
     
-    return x_distance < 0.0f && y_distance < 0.0f;
+    if (x_distance >= 0.0f || y_distance >= 0.0f) return false;
+    
+    // The boxes overlap; whether the sprites do is up to their masks
+    const CollisionMask *mask       = get_collision_mask();
+    const CollisionMask *other_mask = other->get_collision_mask();
+    if (mask == NULL || other_mask == NULL) return true;
+    
+    return collision_masks_overlap(*mask, m_position.x, m_position.y,
+                                   *other_mask, other->m_position.x, other->m_position.y);
+}
+
+const CollisionMask *Entity::get_collision_mask() const
+{
+    if (m_animation_clip != NULL) return m_animation_clip->frames[m_animation_index].mask;
+    return m_collision_mask;
 }
@@ -1,27 +1,49 @@
+class Terrain;
+struct CollisionMask;
+
 enum EntityType { WIN_PLATFORM, LOSE_PLATFORM, PLAYER, MESSAGE, BACKGROUND };
 
+// Everything needed to draw an entity, copied out after a tick so the
+// renderer never reads an entity the simulation is updating
+struct SpriteSnapshot
+{
+    glm::mat4 model_matrix;
+    GLuint texture_id;
+    const AnimationFrame *frame;   // NULL draws the whole texture
+    bool is_active;
+    
+    // Whether both draw the same pixels; inactive sprites draw nothing at all
+    bool const looks_like(const SpriteSnapshot &other) const
+    {
+        if (is_active != other.is_active) return false;
+        
+        return !is_active || (texture_id == other.texture_id && frame == other.frame &&
+                              model_matrix == other.model_matrix);
+    };
+};
+
 class Entity
 {
 private:
     bool m_is_active = true;
     
-    // ––––– ANIMATION ––––– //
-    int *m_animation_right = NULL; // move to the right
-    int *m_animation_left  = NULL; // move to the left
-    int *m_animation_up    = NULL; // move upwards
-    int *m_animation_down  = NULL; // move downwards
-    
     // ––––– PHYSICS (GRAVITY) ––––– //
     glm::vec3 m_position;
     glm::vec3 m_velocity;
     glm::vec3 m_acceleration;
     
+    // ––––– PHYSICS (WATER CURRENTS) ––––– //
+    glm::vec3 m_current;
+    
+    // ––––– FUEL ––––– //
+    float m_fuel           = 0.0f;
+    float m_fuel_burn_rate = 0.0f; // per second of full thrust; 0 means unlimited
+    
     float m_width  = 1;
     float m_height = 1;
     
 public:
     // ––––– STATIC ATTRIBUTES ––––– //
-    static const int SECONDS_PER_FRAME = 4;
     static const int LEFT  = 0,
                      RIGHT = 1,
                      UP    = 2,
@@ -37,13 +59,11 @@ public:
     glm::vec3 m_movement;
     
     // ––––– ANIMATIONS ––––– //
-    int **m_walking          = new int*[4] { m_animation_left, m_animation_right, m_animation_up, m_animation_down };
-    int *m_animation_indices = NULL;
-    int m_animation_frames   = 0;
-    int m_animation_index    = 0;
-    float m_animation_time   = 0.0f;
-    int m_animation_cols     = 0;
-    int m_animation_rows     = 0;
+    // Clips are owned by an AnimationLibrary and shared between entities
+    const AnimationClip *m_walking[4]     = { NULL, NULL, NULL, NULL };
+    const AnimationClip *m_animation_clip = NULL;
+    int m_animation_index                 = 0;
+    float m_animation_time                = 0.0f;
     
     // ––––– PHYSICS (JUMPING) ––––– //
     bool m_is_jumping     = false;
@@ -54,20 +74,27 @@ public:
     bool m_collided_bottom = false;
     bool m_collided_left   = false;
     bool m_collided_right  = false;
+    
+    // Pixels that count once the boxes overlap; NULL collides as the whole box.
+    // An animated entity uses its current frame's mask instead.
+    const CollisionMask *m_collision_mask = NULL;
 
     // ––––– METHODS ––––– //
     Entity();
     ~Entity();
 
-    void draw_sprite_from_texture_atlas(ShaderProgram *program, GLuint texture_id, int index);
-    void update(float delta_time, Entity *collidable_entities, int collidable_entity_count,
-                bool& g_player_win, bool& g_player_lost);
-    void render(ShaderProgram *program);
+    static void draw_sprite_from_texture_atlas(ShaderProgram *program, GLuint texture_id, const AnimationFrame &frame);
+    void set_animation(const AnimationClip *clip) { m_animation_clip = clip; };
+    void update(float delta_time, Entity **collidable_entities, int collidable_entity_count,
+                bool& g_player_win, bool& g_player_lost, const Terrain *terrain = NULL);
+    void render(ShaderProgram *program) { render_snapshot(program, get_snapshot()); };
+    static void render_snapshot(ShaderProgram *program, const SpriteSnapshot &sprite);
     
-    void const check_collision_y(Entity *collidable_entities, int collidable_entity_count,
+    void const check_collision_y(Entity **collidable_entities, int collidable_entity_count,
                                  bool& g_player_win, bool& g_player_lost);
-    void const check_collision_x(Entity *collidable_entities, int collidable_entity_count,
+    void const check_collision_x(Entity **collidable_entities, int collidable_entity_count,
                                  bool& g_player_win, bool& g_player_lost);
+    void const check_collision_terrain(const Terrain *terrain);
     bool const check_collision(Entity *other) const;
     
     void activate()   { m_is_active = true;  };
@@ -78,15 +105,22 @@ public:
     glm::vec3  const get_movement()     const { return m_movement;     };
     glm::vec3  const get_velocity()     const { return m_velocity;     };
     glm::vec3  const get_acceleration() const { return m_acceleration; };
-    int        const get_width()        const { return m_width;        };
-    int        const get_height()       const { return m_height;       };
+    glm::vec3  const get_current()      const { return m_current;      };
+    float      const get_fuel()         const { return m_fuel;         };
+    float      const get_width()        const { return m_width;        };
+    float      const get_height()       const { return m_height;       };
     EntityType const get_entity_type()  const { return m_type;         };
+    SpriteSnapshot const get_snapshot() const;
+    const CollisionMask *get_collision_mask() const;
     
     // ––––– SETTERS ––––– //
     void const set_position(glm::vec3 new_position)         { m_position = new_position;         };
     void const set_movement(glm::vec3 new_movement)         { m_movement = new_movement;         };
     void const set_velocity(glm::vec3 new_velocity)         { m_velocity = new_velocity;         };
     void const set_acceleration(glm::vec3 new_acceleration) { m_acceleration = new_acceleration; };
+    void const set_current(glm::vec3 new_current)           { m_current = new_current;           };
+    void const set_fuel(float new_fuel)                     { m_fuel = new_fuel;                 };
+    void const set_fuel_burn_rate(float new_burn_rate)      { m_fuel_burn_rate = new_burn_rate;  };
     void const set_width(float new_width)                   { m_width  = new_width;              };
     void const set_height(float new_height)                 { m_height = new_height;             };
     void const set_entity_type(EntityType new_type)         { m_type = new_type;                 };
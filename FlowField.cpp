@@ -0,0 +1,283 @@
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "Arena.h"
+#include "FlowField.h"
+
+#define LOG(argument) std::cout << argument << '\n'
+
+FlowField::FlowField(Arena &arena, glm::vec2 origin, int cols, int rows, float cell_size, int max_eddies)
+{
+    m_origin        = origin;
+    m_cols          = std::max(cols, 2);
+    m_rows          = std::max(rows, 2);
+    m_cell_size     = cell_size;
+    m_inv_cell_size = 1.0f / cell_size;
+    m_base_current  = glm::vec2(0.0f);
+    m_max_eddies    = max_eddies;
+
+    m_tile_cols = (m_cols + TILE_SIZE - 1) / TILE_SIZE;
+    m_tile_rows = (m_rows + TILE_SIZE - 1) / TILE_SIZE;
+
+    m_flow_x      = arena.allocate_array<float>(m_cols * m_rows);
+    m_flow_y      = arena.allocate_array<float>(m_cols * m_rows);
+    m_eddies      = arena.allocate_array<Eddy>(m_max_eddies);
+    m_dirty_tiles = arena.allocate_array<unsigned char>(m_tile_cols * m_tile_rows);
+    if (m_flow_x == NULL || m_flow_y == NULL || m_eddies == NULL || m_dirty_tiles == NULL)
+    {
+        LOG("Level arena is too small for this level's currents.");
+        assert(false);
+
+        // Release builds carry on with an empty field: every loop below runs
+        // over zero nodes, tiles and eddies, and sample() reports still water.
+        m_cols       = m_rows      = 0;
+        m_tile_cols  = m_tile_rows = 0;
+        m_max_eddies = 0;
+        return;
+    }
+
+    std::fill(m_flow_x, m_flow_x + m_cols * m_rows, 0.0f);
+    std::fill(m_flow_y, m_flow_y + m_cols * m_rows, 0.0f);
+    std::fill(m_dirty_tiles, m_dirty_tiles + m_tile_cols * m_tile_rows, 1);
+}
+
+void FlowField::set_base_current(glm::vec2 current)
+{
+    m_base_current = current;
+    std::fill(m_dirty_tiles, m_dirty_tiles + m_tile_cols * m_tile_rows, 1);
+}
+
+void FlowField::add_eddy(const Eddy &eddy)
+{
+    if (m_eddy_count == m_max_eddies) return;
+
+    m_eddies[m_eddy_count++] = eddy;
+    mark_dirty(eddy.centre, eddy.radius);
+}
+
+void FlowField::rebuild()
+{
+    m_tiles_rebuilt = 0;
+
+    for (int tile_y = 0; tile_y < m_tile_rows; tile_y++)
+    {
+        for (int tile_x = 0; tile_x < m_tile_cols; tile_x++)
+        {
+            int tile = tile_y * m_tile_cols + tile_x;
+            if (!m_dirty_tiles[tile]) continue;
+
+            rebuild_tile(tile_x, tile_y);
+            m_dirty_tiles[tile] = 0;
+            m_tiles_rebuilt++;
+        }
+    }
+}
+
+void FlowField::update(float delta_time)
+{
+    if (!m_is_time_varying || m_eddy_count == 0) return;
+
+    float max_x = m_origin.x + (m_cols - 1) * m_cell_size;
+    float max_y = m_origin.y + (m_rows - 1) * m_cell_size;
+
+    for (int i = 0; i < m_eddy_count; i++)
+    {
+        Eddy &eddy = m_eddies[i];
+
+        // The tiles the eddy is leaving and the tiles it is entering are the
+        // only ones whose flow changes this tick.
+        mark_dirty(eddy.centre, eddy.radius);
+
+        eddy.centre += eddy.drift * delta_time;
+
+        // Bounce off the edges of the field so currents stay in the level
+        if (eddy.centre.x < m_origin.x || eddy.centre.x > max_x) eddy.drift.x = -eddy.drift.x;
+        if (eddy.centre.y < m_origin.y || eddy.centre.y > max_y) eddy.drift.y = -eddy.drift.y;
+
+        mark_dirty(eddy.centre, eddy.radius);
+    }
+
+    rebuild();
+}
+
+void FlowField::mark_dirty(glm::vec2 centre, float radius)
+{
+    float tile_extent = TILE_SIZE * m_cell_size;
+
+    int first_x = (int) std::floor((centre.x - radius - m_origin.x) / tile_extent);
+    int last_x  = (int) std::floor((centre.x + radius - m_origin.x) / tile_extent);
+    int first_y = (int) std::floor((centre.y - radius - m_origin.y) / tile_extent);
+    int last_y  = (int) std::floor((centre.y + radius - m_origin.y) / tile_extent);
+
+    first_x = std::max(first_x, 0);
+    first_y = std::max(first_y, 0);
+    last_x  = std::min(last_x, m_tile_cols - 1);
+    last_y  = std::min(last_y, m_tile_rows - 1);
+
+    for (int tile_y = first_y; tile_y <= last_y; tile_y++)
+    {
+        for (int tile_x = first_x; tile_x <= last_x; tile_x++)
+        {
+            m_dirty_tiles[tile_y * m_tile_cols + tile_x] = 1;
+        }
+    }
+}
+
+void FlowField::rebuild_tile(int tile_x, int tile_y)
+{
+    int first_col = tile_x * TILE_SIZE;
+    int first_row = tile_y * TILE_SIZE;
+    int last_col  = std::min(first_col + TILE_SIZE, m_cols);
+    int last_row  = std::min(first_row + TILE_SIZE, m_rows);
+
+    // Reset the tile to the level-wide current...
+    for (int row = first_row; row < last_row; row++)
+    {
+        for (int col = first_col; col < last_col; col++)
+        {
+            m_flow_x[row * m_cols + col] = m_base_current.x;
+            m_flow_y[row * m_cols + col] = m_base_current.y;
+        }
+    }
+
+    // ...then add the swirl of every eddy that reaches it
+    float tile_min_x = m_origin.x + first_col * m_cell_size;
+    float tile_min_y = m_origin.y + first_row * m_cell_size;
+    float tile_max_x = m_origin.x + (last_col - 1) * m_cell_size;
+    float tile_max_y = m_origin.y + (last_row - 1) * m_cell_size;
+
+    for (int i = 0; i < m_eddy_count; i++)
+    {
+        const Eddy &eddy = m_eddies[i];
+
+        if (eddy.centre.x + eddy.radius < tile_min_x || eddy.centre.x - eddy.radius > tile_max_x ||
+            eddy.centre.y + eddy.radius < tile_min_y || eddy.centre.y - eddy.radius > tile_max_y) continue;
+
+        float radius_squared = eddy.radius * eddy.radius;
+
+        for (int row = first_row; row < last_row; row++)
+        {
+            float y_distance = m_origin.y + row * m_cell_size - eddy.centre.y;
+
+            for (int col = first_col; col < last_col; col++)
+            {
+                float x_distance = m_origin.x + col * m_cell_size - eddy.centre.x;
+                float distance_squared = x_distance * x_distance + y_distance * y_distance;
+
+                if (distance_squared >= radius_squared || distance_squared == 0.0f) continue;
+
+                // Tangential swirl, strongest at the core and fading to zero at the rim
+                float distance = std::sqrt(distance_squared);
+                float swirl    = eddy.strength * (1.0f - distance / eddy.radius) / distance;
+
+                m_flow_x[row * m_cols + col] -= y_distance * swirl;
+                m_flow_y[row * m_cols + col] += x_distance * swirl;
+            }
+        }
+    }
+}
+
+glm::vec2 FlowField::sample(glm::vec2 position) const
+{
+    glm::vec2 flow;
+    sample(&position.x, &position.y, &flow.x, &flow.y, 1);
+    return flow;
+}
+
+void FlowField::sample(const float *xs, const float *ys, float *out_x, float *out_y, int count) const
+{
+    if (m_cols == 0)
+    {
+        std::fill(out_x, out_x + count, 0.0f);
+        std::fill(out_y, out_y + count, 0.0f);
+        return;
+    }
+
+    float max_grid_x = (float) (m_cols - 1);
+    float max_grid_y = (float) (m_rows - 1);
+
+    int i = 0;
+
+#if defined(__SSE2__)
+    // Four bodies at a time: grid coordinates and bilinear weights in SIMD, the
+    // four corner gathers per lane in scalar (SSE2 has no gather), blend in SIMD.
+    const __m128 origin_x  = _mm_set1_ps(m_origin.x);
+    const __m128 origin_y  = _mm_set1_ps(m_origin.y);
+    const __m128 inv_cell  = _mm_set1_ps(m_inv_cell_size);
+    const __m128 zero      = _mm_setzero_ps();
+    const __m128 max_x     = _mm_set1_ps(max_grid_x);
+    const __m128 max_y     = _mm_set1_ps(max_grid_y);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 grid_x = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(xs + i), origin_x), inv_cell);
+        __m128 grid_y = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(ys + i), origin_y), inv_cell);
+        grid_x = _mm_min_ps(_mm_max_ps(grid_x, zero), max_x);
+        grid_y = _mm_min_ps(_mm_max_ps(grid_y, zero), max_y);
+
+        // Coordinates are clamped non-negative, so truncation is floor
+        __m128i cell_x = _mm_cvttps_epi32(grid_x);
+        __m128i cell_y = _mm_cvttps_epi32(grid_y);
+        __m128 weight_x = _mm_sub_ps(grid_x, _mm_cvtepi32_ps(cell_x));
+        __m128 weight_y = _mm_sub_ps(grid_y, _mm_cvtepi32_ps(cell_y));
+
+        alignas(16) int cols[4], rows[4];
+        _mm_store_si128((__m128i *) cols, cell_x);
+        _mm_store_si128((__m128i *) rows, cell_y);
+
+        alignas(16) float x00[4], x10[4], x01[4], x11[4];
+        alignas(16) float y00[4], y10[4], y01[4], y11[4];
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+            int node   = rows[lane] * m_cols + cols[lane];
+            int step_x = cols[lane] < m_cols - 1 ? 1 : 0;
+            int step_y = rows[lane] < m_rows - 1 ? m_cols : 0;
+
+            x00[lane] = m_flow_x[node];
+            x10[lane] = m_flow_x[node + step_x];
+            x01[lane] = m_flow_x[node + step_y];
+            x11[lane] = m_flow_x[node + step_y + step_x];
+            y00[lane] = m_flow_y[node];
+            y10[lane] = m_flow_y[node + step_x];
+            y01[lane] = m_flow_y[node + step_y];
+            y11[lane] = m_flow_y[node + step_y + step_x];
+        }
+
+        __m128 bottom_x = _mm_add_ps(_mm_load_ps(x00), _mm_mul_ps(_mm_sub_ps(_mm_load_ps(x10), _mm_load_ps(x00)), weight_x));
+        __m128 top_x    = _mm_add_ps(_mm_load_ps(x01), _mm_mul_ps(_mm_sub_ps(_mm_load_ps(x11), _mm_load_ps(x01)), weight_x));
+        __m128 bottom_y = _mm_add_ps(_mm_load_ps(y00), _mm_mul_ps(_mm_sub_ps(_mm_load_ps(y10), _mm_load_ps(y00)), weight_x));
+        __m128 top_y    = _mm_add_ps(_mm_load_ps(y01), _mm_mul_ps(_mm_sub_ps(_mm_load_ps(y11), _mm_load_ps(y01)), weight_x));
+
+        _mm_storeu_ps(out_x + i, _mm_add_ps(bottom_x, _mm_mul_ps(_mm_sub_ps(top_x, bottom_x), weight_y)));
+        _mm_storeu_ps(out_y + i, _mm_add_ps(bottom_y, _mm_mul_ps(_mm_sub_ps(top_y, bottom_y), weight_y)));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        float grid_x = std::min(std::max((xs[i] - m_origin.x) * m_inv_cell_size, 0.0f), max_grid_x);
+        float grid_y = std::min(std::max((ys[i] - m_origin.y) * m_inv_cell_size, 0.0f), max_grid_y);
+
+        int col = (int) grid_x;
+        int row = (int) grid_y;
+        float weight_x = grid_x - col;
+        float weight_y = grid_y - row;
+
+        int node   = row * m_cols + col;
+        int step_x = col < m_cols - 1 ? 1 : 0;
+        int step_y = row < m_rows - 1 ? m_cols : 0;
+
+        float bottom_x = m_flow_x[node] + (m_flow_x[node + step_x] - m_flow_x[node]) * weight_x;
+        float top_x    = m_flow_x[node + step_y] + (m_flow_x[node + step_y + step_x] - m_flow_x[node + step_y]) * weight_x;
+        float bottom_y = m_flow_y[node] + (m_flow_y[node + step_x] - m_flow_y[node]) * weight_x;
+        float top_y    = m_flow_y[node + step_y] + (m_flow_y[node + step_y + step_x] - m_flow_y[node + step_y]) * weight_x;
+
+        out_x[i] = bottom_x + (top_x - bottom_x) * weight_y;
+        out_y[i] = bottom_y + (top_y - bottom_y) * weight_y;
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "glm/mat4x4.hpp"
+
+class Arena;
+
+// A drifting vortex. Its swirl only reaches cells within `radius` of `centre`,
+// which is what lets the field be refreshed one tile at a time.
+struct Eddy
+{
+    glm::vec2 centre;
+    glm::vec2 drift;
+    float radius;
+    float strength;
+};
+
+class FlowField
+{
+private:
+    // ––––– GRID ––––– //
+    // Flow vectors are stored per grid node as two flat row-major arrays so a
+    // batch of bodies can be sampled with straight SIMD loads. All storage comes
+    // from the level arena. If the arena cannot hold it the field is left with
+    // zero nodes and samples as still water.
+    int m_cols;
+    int m_rows;
+    float m_cell_size;
+    float m_inv_cell_size;
+    glm::vec2 m_origin;
+    float *m_flow_x;
+    float *m_flow_y;
+
+    // ––––– TIME-VARYING MODE ––––– //
+    glm::vec2 m_base_current;
+    Eddy *m_eddies;
+    int m_eddy_count = 0;
+    int m_max_eddies;
+    bool m_is_time_varying = false;
+    int m_tile_cols;
+    int m_tile_rows;
+    unsigned char *m_dirty_tiles;
+    int m_tiles_rebuilt = 0;
+
+    void mark_dirty(glm::vec2 centre, float radius);
+    void rebuild_tile(int tile_x, int tile_y);
+
+public:
+    // ––––– STATIC ATTRIBUTES ––––– //
+    static const int TILE_SIZE = 8; // nodes per tile edge
+
+    // ––––– METHODS ––––– //
+    FlowField(Arena &arena, glm::vec2 origin, int cols, int rows, float cell_size, int max_eddies);
+
+    void set_base_current(glm::vec2 current);
+    void add_eddy(const Eddy &eddy);
+    void rebuild();
+    void update(float delta_time);
+
+    glm::vec2 sample(glm::vec2 position) const;
+    void sample(const float *xs, const float *ys, float *out_x, float *out_y, int count) const;
+
+    void set_time_varying(bool time_varying) { m_is_time_varying = time_varying; };
+
+    // ––––– GETTERS ––––– //
+    int   const get_cols()          const { return m_cols;          };
+    int   const get_rows()          const { return m_rows;          };
+    float const get_cell_size()     const { return m_cell_size;     };
+    int   const get_tiles_rebuilt() const { return m_tiles_rebuilt; };
+};
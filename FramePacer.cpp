@@ -0,0 +1,103 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include "FramePacer.h"
+
+#define LOG(argument) std::cout << argument << '\n'
+
+const double MILLISECONDS_PER_SECOND = 1000.0;
+const double SPIN_MILLISECONDS       = 1.0;   // sleeps wake up to about this late
+
+void FramePacer::initialise(int target_fps, VsyncMode vsync)
+{
+    m_frequency     = SDL_GetPerformanceFrequency();
+    m_period        = target_fps > 0 ? m_frequency / target_fps : 0;
+    m_spin_duration = (Uint64) (SPIN_MILLISECONDS * m_frequency / MILLISECONDS_PER_SECOND);
+
+    switch (vsync)
+    {
+        case VSYNC_OFF: SDL_GL_SetSwapInterval(0); break;
+        case VSYNC_ON:  SDL_GL_SetSwapInterval(1); break;
+
+        case VSYNC_ADAPTIVE:
+            if (SDL_GL_SetSwapInterval(-1) != 0)
+            {
+                LOG("Adaptive vsync is not supported; using vsync.");
+                SDL_GL_SetSwapInterval(1);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    m_start      = SDL_GetPerformanceCounter();
+    m_last_frame = m_start;
+    m_deadline   = m_start + m_period;
+    m_cpu_start  = std::clock();
+}
+
+double FramePacer::milliseconds(Uint64 counter_ticks) const
+{
+    return counter_ticks * MILLISECONDS_PER_SECOND / m_frequency;
+}
+
+void FramePacer::end_frame()
+{
+    Uint64 now = SDL_GetPerformanceCounter();
+
+    if (m_period > 0)
+    {
+        if (now < m_deadline)
+        {
+            // Sleep through most of the wait, then spin the last stretch
+            if (m_deadline - now > m_spin_duration)
+            {
+                Uint64 sleep = m_deadline - now - m_spin_duration;
+                std::this_thread::sleep_for(std::chrono::microseconds(sleep * 1000000 / m_frequency));
+
+                Uint64 woken = SDL_GetPerformanceCounter();
+                m_sleep_total += milliseconds(woken - now);
+                now = woken;
+            }
+
+            Uint64 spin_start = now;
+            while (now < m_deadline) now = SDL_GetPerformanceCounter();
+            if (now > spin_start) m_spin_total += milliseconds(now - spin_start);
+
+            m_deadline += m_period;
+        }
+        else
+        {
+            m_missed_deadlines++;
+            m_deadline = now - m_deadline >= m_period ? now + m_period : m_deadline + m_period;
+        }
+    }
+
+    double interval = milliseconds(now - m_last_frame);
+    m_last_frame = now;
+
+    m_intervals++;
+    m_interval_total   += interval;
+    m_interval_squares += interval * interval;
+    if (interval > m_interval_maximum) m_interval_maximum = interval;
+}
+
+void FramePacer::report() const
+{
+    if (m_intervals == 0) return;
+
+    double seconds = milliseconds(m_last_frame - m_start) / MILLISECONDS_PER_SECOND;
+    double cpu     = (double) (std::clock() - m_cpu_start) / CLOCKS_PER_SEC;
+
+    double mean     = m_interval_total / m_intervals;
+    double variance = m_interval_squares / m_intervals - mean * mean;
+    double jitter   = std::sqrt(variance > 0.0 ? variance : 0.0);
+
+    LOG("Frame pacing: " << (m_period > 0 ? m_frequency / (double) m_period : 0.0) << " fps target, interval "
+        << mean << " ms mean / " << jitter << " ms jitter (std dev) / " << m_interval_maximum << " ms max, "
+        << m_missed_deadlines << " deadlines missed; " << m_sleep_total / m_intervals << " ms asleep and "
+        << m_spin_total / m_intervals << " ms spinning per frame; CPU "
+        << (seconds > 0.0 ? 100.0 * cpu / seconds : 0.0) << "% of one core.");
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <ctime>
+#include <SDL.h>
+
+enum VsyncMode { VSYNC_DEFAULT, VSYNC_OFF, VSYNC_ON, VSYNC_ADAPTIVE };
+
+/**
+ * Holds the main loop to a target frame rate without spinning a core.
+ *
+ * Each frame has a deadline one period after the last. end_frame() sleeps
+ * until just short of it and spins only the final stretch, because a sleep
+ * can wake a little late but a spin cannot. Deadlines advance by whole
+ * periods so small overshoots do not accumulate; a frame that runs more than
+ * a period late restarts the schedule rather than rushing to catch up.
+ *
+ * Adaptive vsync (swap interval -1) waits for the display only when the
+ * frame is on time, tearing instead of dropping to half rate when it is late.
+ * Drivers without it get ordinary vsync.
+ *
+ * Frame intervals, their jitter and the process's CPU use are measured
+ * whether or not a target is set, and logged by report().
+ */
+class FramePacer
+{
+private:
+    Uint64 m_frequency     = 0;
+    Uint64 m_period        = 0;   // counter ticks per frame; 0 runs unpaced
+    Uint64 m_spin_duration = 0;
+    Uint64 m_deadline      = 0;
+
+    // ––––– MEASUREMENT ––––– //
+    Uint64 m_start         = 0;
+    Uint64 m_last_frame    = 0;
+    std::clock_t m_cpu_start = 0;
+    int m_intervals          = 0;
+    double m_interval_total   = 0.0;   // milliseconds
+    double m_interval_squares = 0.0;
+    double m_interval_maximum = 0.0;
+    double m_sleep_total      = 0.0;
+    double m_spin_total       = 0.0;
+    int m_missed_deadlines    = 0;
+
+    double milliseconds(Uint64 counter_ticks) const;
+
+public:
+    // ––––– METHODS ––––– //
+    // Needs the GL context current for the swap interval. A target of 0
+    // leaves the frame rate to vsync, or unlimited.
+    void initialise(int target_fps, VsyncMode vsync);
+
+    // Call once per frame, after the swap
+    void end_frame();
+
+    void report() const;
+};
@@ -0,0 +1,87 @@
+#define GL_SILENCE_DEPRECATION
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "GoldenImage.h"
+
+ImageDifference compare_images(const unsigned char *actual, const unsigned char *expected, int width, int height,
+                               int tolerance, unsigned char *diff)
+{
+    ImageDifference result;
+
+    for (size_t i = 0; i < (size_t) width * height; i++)
+    {
+        const unsigned char *a = actual + i * 3;
+        const unsigned char *e = expected + i * 3;
+
+        int difference = 0;
+        for (int channel = 0; channel < 3; channel++)
+        {
+            int channel_difference = abs(a[channel] - e[channel]);
+            if (channel_difference > difference) difference = channel_difference;
+        }
+
+        if (difference > result.max_difference) result.max_difference = difference;
+        bool is_over = difference > tolerance;
+        if (is_over) result.pixels_over++;
+
+        if (diff != NULL)
+        {
+            unsigned char *out = diff + i * 3;
+            if (is_over)
+            {
+                out[0] = 255;
+                out[1] = 0;
+                out[2] = 0;
+            }
+            else
+            {
+                unsigned char grey = (unsigned char) (64 + (e[0] + e[1] + e[2]) / 12);
+                out[0] = out[1] = out[2] = grey;
+            }
+        }
+    }
+
+    return result;
+}
+
+// ––––– GPU TIMER ––––– //
+void GpuTimer::initialise()
+{
+    const char *extensions = (const char *) glGetString(GL_EXTENSIONS);
+    const char *version    = (const char *) glGetString(GL_VERSION);
+
+    int major = 0, minor = 0;
+    if (version != NULL) sscanf(version, "%d.%d", &major, &minor);
+
+    m_is_supported = major > 3 || (major == 3 && minor >= 3) ||
+                     (extensions != NULL && (strstr(extensions, "GL_ARB_timer_query") != NULL ||
+                                             strstr(extensions, "GL_EXT_timer_query") != NULL));
+
+    if (m_is_supported) glGenQueries(1, &m_query);
+}
+
+void GpuTimer::shutdown()
+{
+    if (m_query != 0) glDeleteQueries(1, &m_query);
+    m_query = 0;
+    m_is_supported = false;
+}
+
+void GpuTimer::begin()
+{
+    if (m_is_supported) glBeginQuery(GL_TIME_ELAPSED, m_query);
+}
+
+double GpuTimer::end()
+{
+    if (!m_is_supported) return -1.0;
+
+    glEndQuery(GL_TIME_ELAPSED);
+
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(m_query, GL_QUERY_RESULT, &nanoseconds);
+    return nanoseconds / 1.0e6;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+
+/**
+ * Pieces of the golden-image regression run (main.cpp, --golden): comparing a
+ * rendered frame against its stored PNG, and timing frames on the GPU.
+ */
+struct ImageDifference
+{
+    int max_difference = 0;   // largest per-channel difference anywhere
+    int pixels_over    = 0;   // pixels with a channel further off than the tolerance
+};
+
+// Both images 8-bit RGB, the same size. When `diff` is given it receives an
+// RGB picture of the result: passing pixels as a faded grey copy of the
+// expected image, failing pixels in solid red.
+ImageDifference compare_images(const unsigned char *actual, const unsigned char *expected, int width, int height,
+                               int tolerance, unsigned char *diff);
+
+/**
+ * GL_TIME_ELAPSED query around a stretch of GL calls. end() waits for the GPU
+ * to finish them, so this is for harnesses, not the game loop. Without timer
+ * queries (GL 3.3 or ARB/EXT_timer_query) end() returns -1.
+ *
+ * Take the median of several runs: some drivers (llvmpipe among them) answer
+ * the first query that does any work with the time since start-up.
+ */
+class GpuTimer
+{
+private:
+    GLuint m_query      = 0;
+    bool m_is_supported = false;
+
+public:
+    // ––––– METHODS ––––– //
+    void initialise();
+    void shutdown();
+    void begin();
+    double end();   // milliseconds
+
+    // ––––– GETTERS ––––– //
+    bool const is_supported() const { return m_is_supported; };
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit FNV-1a: the keys of the program binary, texture and collision mask
+// caches, and the source hashes stored in asset files. Not for anything that
+// has to resist a deliberate collision.
+const uint64_t HASH_OFFSET_BASIS = 14695981039346656037ULL;
+
+inline uint64_t hash_bytes(const void *data, size_t size, uint64_t hash = HASH_OFFSET_BASIS)
+{
+    const unsigned char *bytes = (const unsigned char *) data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
@@ -0,0 +1,223 @@
+#define GL_SILENCE_DEPRECATION
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+#include "HotReload.h"
+
+#define LOG(argument) std::cout << argument << '\n'
+
+AssetWatcher::~AssetWatcher()
+{
+    shutdown();
+}
+
+bool AssetWatcher::initialise(const char *const directories[], int directory_count)
+{
+#ifdef __linux__
+    m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify_fd < 0)
+    {
+        LOG("Unable to start the asset watcher.");
+        return false;
+    }
+
+    // Editors either rewrite a file in place or write a temporary and rename
+    // it over the original, so watch for both
+    for (int i = 0; i < directory_count; i++)
+    {
+        int descriptor = inotify_add_watch(m_inotify_fd, directories[i], IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (descriptor < 0)
+        {
+            LOG("Unable to watch " << directories[i] << " for changes.");
+            continue;
+        }
+
+        m_directories.push_back(directories[i]);
+        m_watch_descriptors.push_back(descriptor);
+    }
+
+    m_is_running = true;
+    m_decoder = std::thread(&AssetWatcher::decode_loop, this);
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AssetWatcher::shutdown()
+{
+    if (m_decoder.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_is_running = false;
+        }
+        m_wakeup.notify_one();
+        m_decoder.join();
+    }
+
+    m_decoded.clear();
+    m_pending.clear();
+
+#ifdef __linux__
+    if (m_inotify_fd >= 0) close(m_inotify_fd);
+#endif
+    m_inotify_fd = -1;
+}
+
+void AssetWatcher::track_shader(ShaderProgram *program)
+{
+    m_shaders.push_back(program);
+}
+
+void AssetWatcher::track_texture(const char *filepath, GLuint texture_id, const TextureOptions &options,
+                                 const TextureImage &image)
+{
+    m_textures.push_back({ filepath, texture_id, options, image.width, image.height, image.level_count,
+                           image.compressed_format });
+}
+
+void AssetWatcher::untrack_texture(GLuint texture_id)
+{
+    for (size_t i = 0; i < m_textures.size(); i++)
+    {
+        if (m_textures[i].texture_id == texture_id)
+        {
+            m_textures.erase(m_textures.begin() + i);
+            return;
+        }
+    }
+}
+
+bool AssetWatcher::poll()
+{
+    bool shaders_reloaded = false;
+    m_has_changed = false;
+
+#ifdef __linux__
+    if (m_inotify_fd < 0) return false;
+
+    // ––––– FILE CHANGES ––––– //
+    alignas(struct inotify_event) char buffer[4096];
+    ssize_t length;
+
+    while ((length = read(m_inotify_fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (char *cursor = buffer; cursor < buffer + length; )
+        {
+            const struct inotify_event *event = (const struct inotify_event *) cursor;
+            cursor += sizeof(struct inotify_event) + event->len;
+
+            if (event->len == 0) continue;
+
+            for (size_t i = 0; i < m_watch_descriptors.size(); i++)
+            {
+                if (m_watch_descriptors[i] != event->wd) continue;
+
+                if (handle_change(m_directories[i] + "/" + event->name)) shaders_reloaded = m_has_changed = true;
+            }
+        }
+    }
+
+    // ––––– FINISHED DECODES ––––– //
+    // At most one upload per frame keeps big textures from landing all at once
+    DecodedImage decoded = { 0, TextureImage() };
+    {
+        std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+        if (lock.owns_lock() && !m_decoded.empty())
+        {
+            decoded = std::move(m_decoded.front());
+            m_decoded.pop_front();
+        }
+    }
+
+    if (decoded.texture_id != 0)
+    {
+        const TextureImage &image = decoded.image;
+
+        for (TrackedTexture &texture : m_textures)
+        {
+            if (texture.texture_id != decoded.texture_id) continue;
+
+            // Same size, mip count and format updates the existing storage in
+            // place; anything else (say a PNG edited past its .bc7) needs fresh storage
+            bool same_size = image.width == texture.width && image.height == texture.height &&
+                             image.level_count == texture.level_count &&
+                             image.compressed_format == texture.compressed_format;
+            replace_texture(texture.texture_id, image, same_size);
+            m_has_changed = true;
+
+            texture.width             = image.width;
+            texture.height            = image.height;
+            texture.level_count       = image.level_count;
+            texture.compressed_format = image.compressed_format;
+
+            LOG("Reloaded " << texture.filepath);
+        }
+    }
+#endif
+
+    return shaders_reloaded;
+}
+
+bool AssetWatcher::handle_change(const std::string &filepath)
+{
+    bool shaders_reloaded = false;
+
+    for (ShaderProgram *program : m_shaders)
+    {
+        if (filepath != program->vertexShaderPath && filepath != program->fragmentShaderPath) continue;
+
+        if (program->Reload())
+        {
+            LOG("Reloaded shader program after " << filepath << " changed.");
+            shaders_reloaded = true;
+        }
+        else
+        {
+            LOG("Kept the previous shader program; " << filepath << " did not build.");
+        }
+    }
+
+    for (const TrackedTexture &texture : m_textures)
+    {
+        if (filepath != texture.filepath) continue;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending.push_back(texture);
+        }
+        m_wakeup.notify_one();
+    }
+
+    return shaders_reloaded;
+}
+
+void AssetWatcher::decode_loop()
+{
+    while (true)
+    {
+        TrackedTexture texture;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeup.wait(lock, [this] { return !m_is_running || !m_pending.empty(); });
+
+            if (!m_is_running) return;
+
+            texture = m_pending.front();
+            m_pending.pop_front();
+        }
+
+        TextureImage image;
+
+        // A half-written file fails to decode; the next write event retries it
+        if (!build_texture_image(texture.filepath.c_str(), texture.options, image)) continue;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_decoded.push_back({ texture.texture_id, std::move(image) });
+    }
+}
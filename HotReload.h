@@ -0,0 +1,88 @@
+#pragma once
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ShaderProgram.h"
+#include "Texture.h"
+
+/**
+ * Watches shaders/ and assets/ with inotify and swaps changed files into the
+ * running game.
+ *
+ *  - Shaders are rebuilt in place with ShaderProgram::Reload(), which keeps
+ *    the old program if the new one fails to compile or link.
+ *  - Textures are rebuilt (decode, downscale, mips) on a background thread
+ *    with their original TextureOptions. poll() then uploads the finished
+ *    levels into the existing texture with glTexSubImage2D, one texture per
+ *    frame, so the render loop never waits on the decoder.
+ *
+ * Everything except decoding happens on the GL thread inside poll(). On
+ * platforms without inotify the watcher does nothing.
+ */
+class AssetWatcher
+{
+private:
+    struct TrackedTexture
+    {
+        std::string filepath;
+        GLuint texture_id;
+        TextureOptions options;
+        int width;
+        int height;
+        int level_count;
+        GLenum compressed_format;
+    };
+
+    struct DecodedImage
+    {
+        GLuint texture_id;
+        TextureImage image;
+    };
+
+    int m_inotify_fd = -1;
+    std::vector<std::string> m_directories;
+    std::vector<int> m_watch_descriptors;
+
+    std::vector<ShaderProgram *> m_shaders;
+    std::vector<TrackedTexture> m_textures;
+
+    // ––––– DECODER THREAD ––––– //
+    std::thread m_decoder;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::deque<TrackedTexture> m_pending;
+    std::deque<DecodedImage> m_decoded;
+    bool m_is_running = false;
+
+    bool m_has_changed = false;
+
+    void decode_loop();
+    bool handle_change(const std::string &filepath);
+
+public:
+    // ––––– METHODS ––––– //
+    ~AssetWatcher();
+
+    bool initialise(const char *const directories[], int directory_count);
+    void shutdown();
+
+    void track_shader(ShaderProgram *program);
+    void track_texture(const char *filepath, GLuint texture_id, const TextureOptions &options,
+                       const TextureImage &image);
+    void untrack_texture(GLuint texture_id);
+
+    // Returns true when a shader program was rebuilt and needs its uniforms again
+    bool poll();
+
+    bool const is_watching() const { return m_inotify_fd >= 0; };
+    bool const has_changed()  const { return m_has_changed;      }; // anything reloaded in the last poll()
+};
@@ -0,0 +1,113 @@
+#define GL_SILENCE_DEPRECATION
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <cmath>
+#include <SDL.h>
+#include <SDL_opengl.h>
+#include "glm/mat4x4.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "ShaderProgram.h"
+#include "Hud.h"
+
+const float HUD_FONT_SIZE    = 0.3f,
+            HUD_FONT_SPACING = -0.12f,
+            HUD_LINE_HEIGHT  = 0.35f;
+
+const int HUD_LINE_CAPACITY = TextBatch::MAX_SPAN_LENGTH;
+
+// ––––– FORMATTING ––––– //
+// Each helper appends at `length` and returns the new length, never writing
+// past the line buffer.
+static int append_text(char *line, int length, const char *text)
+{
+    while (*text != '\0' && length < HUD_LINE_CAPACITY) line[length++] = *text++;
+    line[length] = '\0';
+    return length;
+}
+
+static int append_unsigned(char *line, int length, unsigned int value)
+{
+    char digits[10];
+    int digit_count = 0;
+
+    do
+    {
+        digits[digit_count++] = (char) ('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    while (digit_count > 0 && length < HUD_LINE_CAPACITY) line[length++] = digits[--digit_count];
+    line[length] = '\0';
+    return length;
+}
+
+static int append_fixed(char *line, int length, float value, int decimals)
+{
+    unsigned int scale = 1;
+    for (int i = 0; i < decimals; i++) scale *= 10;
+
+    unsigned int scaled = (unsigned int) lroundf(fabsf(value) * scale);
+
+    if (value < 0.0f && scaled != 0) length = append_text(line, length, "-");
+    length = append_unsigned(line, length, scaled / scale);
+
+    if (decimals > 0)
+    {
+        length = append_text(line, length, ".");
+
+        // Pad the fraction with leading zeros, e.g. 0.05 -> "05"
+        unsigned int fraction = scaled % scale;
+        for (unsigned int place = scale / 10; place > 1 && fraction < place; place /= 10)
+        {
+            length = append_text(line, length, "0");
+        }
+        length = append_unsigned(line, length, fraction);
+    }
+
+    return length;
+}
+
+// ––––– HUD ––––– //
+Hud::Hud(GLuint font_texture_id, glm::vec3 top_left) : m_text(font_texture_id)
+{
+    m_fuel_span     = m_text.add_span(top_left, HUD_FONT_SIZE, HUD_FONT_SPACING);
+    m_velocity_span = m_text.add_span(top_left - glm::vec3(0.0f, HUD_LINE_HEIGHT, 0.0f),
+                                      HUD_FONT_SIZE, HUD_FONT_SPACING);
+    m_altitude_span = m_text.add_span(top_left - glm::vec3(0.0f, HUD_LINE_HEIGHT * 2.0f, 0.0f),
+                                      HUD_FONT_SIZE, HUD_FONT_SPACING);
+    m_score_span    = m_text.add_span(top_left - glm::vec3(0.0f, HUD_LINE_HEIGHT * 3.0f, 0.0f),
+                                      HUD_FONT_SIZE, HUD_FONT_SPACING);
+    m_line[0] = '\0';
+}
+
+void Hud::update(float fuel, glm::vec3 velocity, float altitude, int score)
+{
+    int length;
+
+    length = append_text(m_line, 0, "FUEL ");
+    length = append_fixed(m_line, length, fuel, 0);
+    m_text.set_text(m_fuel_span, m_line);
+
+    length = append_text(m_line, 0, "VEL ");
+    length = append_fixed(m_line, length, velocity.x, 1);
+    length = append_text(m_line, length, " ");
+    length = append_fixed(m_line, length, velocity.y, 1);
+    m_text.set_text(m_velocity_span, m_line);
+
+    length = append_text(m_line, 0, "ALT ");
+    length = append_fixed(m_line, length, altitude, 1);
+    m_text.set_text(m_altitude_span, m_line);
+
+    length = append_text(m_line, 0, "SCORE ");
+    length = append_unsigned(m_line, length, (unsigned int) score);
+    m_text.set_text(m_score_span, m_line);
+}
+
+void Hud::render(ShaderProgram *program)
+{
+    m_text.render(program);
+}
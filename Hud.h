@@ -0,0 +1,31 @@
+#pragma once
+
+#include "TextBatch.h"
+
+/**
+ * Fuel, velocity, altitude and score readouts.
+ *
+ * Numbers are formatted by hand into a fixed line buffer, so updating the HUD
+ * never touches the heap, and all four lines go out through one TextBatch
+ * draw call. Values are rounded to what is displayed, which means the glyph
+ * buffer is only rebuilt when a visible digit changes.
+ */
+class Hud
+{
+private:
+    TextBatch m_text;
+    int m_fuel_span;
+    int m_velocity_span;
+    int m_altitude_span;
+    int m_score_span;
+    char m_line[TextBatch::MAX_SPAN_LENGTH + 1];
+
+public:
+    // ––––– METHODS ––––– //
+    Hud(GLuint font_texture_id, glm::vec3 top_left);
+
+    void update(float fuel, glm::vec3 velocity, float altitude, int score);
+    void render(ShaderProgram *program);
+
+    bool const is_dirty() const { return m_text.is_dirty(); };
+};
@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include "glm/glm.hpp"
+#include "Input.h"
+
+#define LOG(argument) std::cout << argument << '\n'
+
+const float MILLISECONDS_PER_SECOND = 1000.0f;
+const float STICK_DEAD_ZONE         = 0.25f;   // fraction of full travel ignored around the centre
+const float STICK_RANGE             = 32767.0f;
+
+void InputSystem::initialise()
+{
+    // Controllers already plugged in announce themselves with
+    // SDL_CONTROLLERDEVICEADDED once the subsystem is up
+    if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) != 0)
+    {
+        LOG("Unable to start game controller support: " << SDL_GetError());
+    }
+}
+
+void InputSystem::shutdown()
+{
+    for (int i = 0; i < MAX_GAME_CONTROLLERS; i++)
+    {
+        if (m_controllers[i] != NULL) SDL_GameControllerClose(m_controllers[i]);
+        m_controllers[i] = NULL;
+    }
+
+    if (m_applied_events > 0)
+    {
+        LOG("Input: " << m_applied_events << " events, tick latency mean "
+            << get_mean_tick_latency() * MILLISECONDS_PER_SECOND << " ms / max "
+            << m_max_tick_latency * MILLISECONDS_PER_SECOND << " ms, wall latency mean "
+            << get_mean_wall_latency() * MILLISECONDS_PER_SECOND << " ms / max "
+            << m_max_wall_latency * MILLISECONDS_PER_SECOND << " ms.");
+    }
+}
+
+// ––––– CONTROLLERS ––––– //
+void InputSystem::open_controller(int device_index)
+{
+    if (!SDL_IsGameController(device_index)) return;
+
+    for (int i = 0; i < MAX_GAME_CONTROLLERS; i++)
+    {
+        if (m_controllers[i] != NULL) continue;
+
+        m_controllers[i] = SDL_GameControllerOpen(device_index);
+        if (m_controllers[i] == NULL) return;
+
+        m_controller_ids[i] = SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(m_controllers[i]));
+        LOG("Game controller connected: " << SDL_GameControllerName(m_controllers[i]));
+        return;
+    }
+}
+
+void InputSystem::close_controller(SDL_JoystickID id)
+{
+    for (int i = 0; i < MAX_GAME_CONTROLLERS; i++)
+    {
+        if (m_controllers[i] == NULL || m_controller_ids[i] != id) continue;
+
+        SDL_GameControllerClose(m_controllers[i]);
+        m_controllers[i] = NULL;
+
+        // A stick that was held when the pad went away must not stay held
+        push(SDL_GetTicks() / MILLISECONDS_PER_SECOND, STICK_X, 0.0f);
+        push(SDL_GetTicks() / MILLISECONDS_PER_SECOND, STICK_Y, 0.0f);
+    }
+}
+
+// ––––– EVENTS ––––– //
+static int direction_for_key(SDL_Scancode scancode)
+{
+    switch (scancode)
+    {
+        case SDL_SCANCODE_LEFT:  case SDL_SCANCODE_A: return 0;
+        case SDL_SCANCODE_RIGHT: case SDL_SCANCODE_D: return 1;
+        case SDL_SCANCODE_UP:    case SDL_SCANCODE_W: return 2;
+        case SDL_SCANCODE_DOWN:  case SDL_SCANCODE_S: return 3;
+        default:                                      return -1;
+    }
+}
+
+static int direction_for_button(Uint8 button)
+{
+    switch (button)
+    {
+        case SDL_CONTROLLER_BUTTON_DPAD_LEFT:  return 0;
+        case SDL_CONTROLLER_BUTTON_DPAD_RIGHT: return 1;
+        case SDL_CONTROLLER_BUTTON_DPAD_UP:    return 2;
+        case SDL_CONTROLLER_BUTTON_DPAD_DOWN:  return 3;
+        default:                               return -1;
+    }
+}
+
+bool InputSystem::handle_event(const SDL_Event &event)
+{
+    float time = event.common.timestamp / MILLISECONDS_PER_SECOND;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    switch (event.type)
+    {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+        {
+            int direction = direction_for_key(event.key.keysym.scancode);
+            if (direction < 0 || event.key.repeat) return direction >= 0;
+
+            push(time, direction, event.type == SDL_KEYDOWN ? 1.0f : -1.0f);
+            return true;
+        }
+
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP:
+        {
+            int direction = direction_for_button(event.cbutton.button);
+            if (direction < 0) return true;
+
+            push(time, direction, event.type == SDL_CONTROLLERBUTTONDOWN ? 1.0f : -1.0f);
+            return true;
+        }
+
+        case SDL_CONTROLLERAXISMOTION:
+        {
+            float value = event.caxis.value / STICK_RANGE;
+            if (event.caxis.axis == SDL_CONTROLLER_AXIS_LEFTX) push(time, STICK_X, value);
+            if (event.caxis.axis == SDL_CONTROLLER_AXIS_LEFTY) push(time, STICK_Y, -value); // SDL's y points down
+            return true;
+        }
+
+        case SDL_CONTROLLERDEVICEADDED:
+            open_controller(event.cdevice.which);
+            return true;
+
+        case SDL_CONTROLLERDEVICEREMOVED:
+            close_controller(event.cdevice.which);
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+void InputSystem::push(float time, int control, float value)
+{
+    // A full queue (the simulation is paused, say) applies its oldest event
+    // straight away rather than losing it, so held state stays right
+    if (m_head - m_tail == QUEUE_SIZE) apply(m_queue[m_tail++ % QUEUE_SIZE]);
+
+    m_queue[m_head++ % QUEUE_SIZE] = { time, control, value };
+}
+
+void InputSystem::apply(const TimedEvent &event)
+{
+    if (event.control == STICK_X || event.control == STICK_Y)
+    {
+        m_stick[event.control - STICK_X] = event.value;
+    }
+    else
+    {
+        m_held[event.control] = std::max(0, m_held[event.control] + (int) event.value);
+    }
+}
+
+// ––––– TICKS ––––– //
+InputSnapshot InputSystem::next_tick(float tick_end, float now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    InputSnapshot snapshot;
+    snapshot.tick = m_tick++;
+
+    while (m_tail != m_head && m_queue[m_tail % QUEUE_SIZE].time <= tick_end)
+    {
+        const TimedEvent &event = m_queue[m_tail++ % QUEUE_SIZE];
+        apply(event);
+
+        float tick_latency = tick_end - event.time;
+        float wall_latency = now - event.time;
+        m_total_tick_latency += tick_latency;
+        m_total_wall_latency += wall_latency;
+        m_max_tick_latency    = std::max(m_max_tick_latency, tick_latency);
+        m_max_wall_latency    = std::max(m_max_wall_latency, wall_latency);
+        m_applied_events++;
+        snapshot.events++;
+    }
+
+    glm::vec2 axis = glm::vec2((m_held[RIGHT] > 0 ? 1.0f : 0.0f) - (m_held[LEFT] > 0 ? 1.0f : 0.0f),
+                               (m_held[UP]    > 0 ? 1.0f : 0.0f) - (m_held[DOWN] > 0 ? 1.0f : 0.0f));
+
+    // Radial dead zone, rescaled so the stick still reaches full thrust
+    glm::vec2 stick  = glm::vec2(m_stick[0], m_stick[1]);
+    float stick_size = glm::length(stick);
+    if (stick_size > STICK_DEAD_ZONE)
+    {
+        axis += stick / stick_size * std::min(1.0f, (stick_size - STICK_DEAD_ZONE) / (1.0f - STICK_DEAD_ZONE));
+    }
+
+    if (glm::length(axis) > 1.0f) axis = glm::normalize(axis);
+    snapshot.axis = axis;
+
+    return snapshot;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <mutex>
+#include <SDL.h>
+#include "glm/vec2.hpp"
+
+const int MAX_GAME_CONTROLLERS = 4;
+
+// Everything one physics tick needs to know about the player's input
+struct InputSnapshot
+{
+    glm::vec2 axis = glm::vec2(0.0f);   // keyboard, d-pad and stick combined; length at most 1
+    int tick       = 0;
+    int events     = 0;                 // events applied for this tick
+};
+
+/**
+ * Keyboard and game controller input, applied per physics tick.
+ *
+ * SDL events are queued with their timestamps as they are polled. Each fixed
+ * tick asks for a snapshot with the time its step ends at: only events up to
+ * that time are applied, so a key pressed part-way through a frame reaches
+ * the tick it happened in, not the first tick of the next frame. An event
+ * is therefore never more than one tick old when the simulation sees it; the
+ * latency stats measure exactly that (and, separately, how much later the
+ * tick actually ran on the wall clock).
+ *
+ * Held directions and stick positions are combined into one axis, so
+ * diagonal thrust works, and the result is clamped to unit length.
+ *
+ * Events are handled on the thread that polls SDL and snapshots are taken on
+ * the simulation thread; the queue is guarded by a mutex held only for the
+ * push or the drain.
+ */
+class InputSystem
+{
+private:
+    enum Control { LEFT, RIGHT, UP, DOWN, STICK_X, STICK_Y, CONTROL_COUNT };
+
+    struct TimedEvent
+    {
+        float time;   // seconds, same clock as SDL_GetTicks()
+        int control;
+        float value;
+    };
+
+    static const unsigned int QUEUE_SIZE = 256; // must be a power of two
+
+    std::mutex m_mutex;
+    TimedEvent m_queue[QUEUE_SIZE];
+    unsigned int m_head = 0;
+    unsigned int m_tail = 0;
+
+    // Keys and d-pad buttons are counted per direction, so releasing one of
+    // two held inputs for the same direction does not stop the thrust
+    int m_held[4]    = { 0, 0, 0, 0 };
+    float m_stick[2] = { 0.0f, 0.0f };
+    int m_tick       = 0;
+
+    SDL_GameController *m_controllers[MAX_GAME_CONTROLLERS] = { NULL };
+    SDL_JoystickID m_controller_ids[MAX_GAME_CONTROLLERS];
+
+    // ––––– LATENCY ––––– //
+    int m_applied_events        = 0;
+    double m_total_tick_latency = 0.0;
+    float m_max_tick_latency    = 0.0f;
+    double m_total_wall_latency = 0.0;
+    float m_max_wall_latency    = 0.0f;
+
+    void push(float time, int control, float value);
+    void apply(const TimedEvent &event);
+    void open_controller(int device_index);
+    void close_controller(SDL_JoystickID id);
+
+public:
+    // ––––– METHODS ––––– //
+    void initialise();
+    void shutdown();
+
+    // Returns false for events that are not input
+    bool handle_event(const SDL_Event &event);
+
+    // `tick_end` is the time the tick's step ends at, `now` when it actually runs
+    InputSnapshot next_tick(float tick_end, float now);
+
+    // ––––– GETTERS ––––– //
+    int   const get_applied_events()   const { return m_applied_events;   };
+    float const get_max_tick_latency() const { return m_max_tick_latency; };
+    float const get_max_wall_latency() const { return m_max_wall_latency; };
+    float const get_mean_tick_latency() const
+    {
+        return m_applied_events > 0 ? (float) (m_total_tick_latency / m_applied_events) : 0.0f;
+    };
+    float const get_mean_wall_latency() const
+    {
+        return m_applied_events > 0 ? (float) (m_total_wall_latency / m_applied_events) : 0.0f;
+    };
+};
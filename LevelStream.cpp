@@ -0,0 +1,422 @@
+#define GL_SILENCE_DEPRECATION
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#define LOG(argument) std::cout << argument << '\n'
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <SDL.h>
+#include <SDL_opengl.h>
+#include "glm/mat4x4.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "ShaderProgram.h"
+#include "Animation.h"
+#include "Entity.h"
+#include "Arena.h"
+#include "Broadphase.h"
+#include "CollisionMask.h"
+#include "LevelStream.h"
+
+const double MILLISECONDS_PER_SECOND = 1000.0;
+
+LevelStream::~LevelStream()
+{
+    shutdown();
+}
+
+bool LevelStream::initialise(const char *filepath, Arena &arena, Broadphase *broadphase,
+                             unsigned int win_texture_id, unsigned int lose_texture_id,
+                             const CollisionMaskImage *win_mask, const CollisionMaskImage *lose_mask)
+{
+#ifdef _WINDOWS
+    LOG("Streamed levels need mmap, which this platform does not have.");
+    return false;
+#else
+    int descriptor = open(filepath, O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0)
+    {
+        LOG("Unable to open level " << filepath << ".");
+        return false;
+    }
+
+    struct stat status;
+    void *mapping = MAP_FAILED;
+    if (fstat(descriptor, &status) == 0 && status.st_size >= (off_t) sizeof(LevelHeader))
+    {
+        mapping = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+    }
+    close(descriptor);   // the mapping keeps the file open
+
+    if (mapping == MAP_FAILED)
+    {
+        LOG("Unable to map level " << filepath << ".");
+        return false;
+    }
+
+    // The header is copied out so the simulation thread never reads the mapping
+    m_file      = (const unsigned char *) mapping;
+    m_file_size = (size_t) status.st_size;
+    memcpy(&m_header, m_file, sizeof(LevelHeader));
+
+    // ––––– VALIDATION ––––– //
+    size_t chunk_count = m_header.chunk_cols > 0 && m_header.chunk_rows > 0
+                       ? (size_t) m_header.chunk_cols * m_header.chunk_rows : 0;
+    size_t table_end   = sizeof(LevelHeader) + chunk_count * sizeof(LevelChunkEntry);
+
+    if (memcmp(m_header.magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC)) != 0 || m_header.version != LEVEL_VERSION ||
+        !(m_header.chunk_size > 0.0f) || chunk_count == 0 || table_end > m_file_size)
+    {
+        LOG("Level " << filepath << " is not a version " << LEVEL_VERSION << " streamed level.");
+        munmap((void *) m_file, m_file_size);
+        m_file = NULL;
+        return false;
+    }
+
+    m_chunks         = (const LevelChunkEntry *) (m_file + sizeof(LevelHeader));
+    m_platforms      = (const LevelPlatform *) (m_file + table_end);
+    m_platform_total = (uint32_t) ((m_file_size - table_end) / sizeof(LevelPlatform));
+
+    // ––––– SLOTS ––––– //
+    m_broadphase     = broadphase;
+    m_texture_ids[0] = win_texture_id;
+    m_texture_ids[1] = lose_texture_id;
+    m_mask_images[0] = win_mask;
+    m_mask_images[1] = lose_mask;
+
+    m_slots = arena.create_array<Slot>(SLOT_COUNT);
+    if (m_slots == NULL)
+    {
+        LOG("Level arena is too small for the streamed level.");
+        assert(false);
+    }
+    for (int i = 0; i < SLOT_COUNT; i++)
+    {
+        m_slots[i].platforms  = arena.create_array<Entity>(MAX_PLATFORMS_PER_CHUNK);
+        m_slots[i].masks      = arena.create_array<CollisionMask>(MAX_PLATFORMS_PER_CHUNK);
+        m_slots[i].mask_words = arena.allocate_array<uint64_t>(MAX_PLATFORMS_PER_CHUNK * MAX_MASK_WORDS);
+        if (m_slots[i].platforms == NULL || m_slots[i].masks == NULL || m_slots[i].mask_words == NULL)
+        {
+            LOG("Level arena is too small for the streamed level.");
+            assert(false);
+        }
+    }
+
+    m_is_running = true;
+    m_loader = std::thread(&LevelStream::load_loop, this);
+
+    LOG("Streaming " << filepath << ": " << m_header.chunk_cols << " x " << m_header.chunk_rows << " chunks of "
+        << m_header.chunk_size << " units, " << m_platform_total << " platforms.");
+    return true;
+#endif
+}
+
+void LevelStream::shutdown()
+{
+    if (m_loader.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_is_running = false;
+        }
+        m_wakeup.notify_one();
+        m_loader.join();
+    }
+
+    if (m_file == NULL) return;
+
+    LOG("Level streaming: " << m_chunks_loaded << " chunks loaded, " << m_chunks_evicted << " evicted, at most "
+        << m_max_resident << " of " << SLOT_COUNT << " slots resident, slowest install "
+        << m_max_install_milliseconds << " ms.");
+
+#ifndef _WINDOWS
+    munmap((void *) m_file, m_file_size);
+#endif
+    m_file  = NULL;
+    m_slots = NULL;
+    m_requests.clear();
+    m_loaded.clear();
+    m_chunks_loaded = m_chunks_evicted = m_max_resident = 0;
+    m_max_install_milliseconds = 0.0;
+}
+
+// ––––– GEOMETRY ––––– //
+// Clamped in float before the cast, which is undefined for values an int
+// cannot hold and for NaN (with the bound first, std::max returns it for
+// NaN). Past the margin a chunk is out of reach of every one in the level, so
+// a position far off it still loads nothing and evicts everything.
+int LevelStream::chunk_index(float chunk, int count)
+{
+    const float margin = (float) (EVICT_RADIUS + 1);
+    return (int) std::floor(std::min(std::max(-margin, chunk), count - 1 + margin));
+}
+
+int LevelStream::chunk_column(float x) const
+{
+    return chunk_index((x - m_header.origin_x) / m_header.chunk_size, m_header.chunk_cols);
+}
+
+int LevelStream::chunk_row(float y) const
+{
+    return chunk_index((y - m_header.origin_y) / m_header.chunk_size, m_header.chunk_rows);
+}
+
+float const LevelStream::get_min_x() const { return m_header.origin_x; }
+float const LevelStream::get_min_y() const { return m_header.origin_y; }
+float const LevelStream::get_max_x() const { return m_header.origin_x + m_header.chunk_cols * m_header.chunk_size; }
+float const LevelStream::get_max_y() const { return m_header.origin_y + m_header.chunk_rows * m_header.chunk_size; }
+
+int const LevelStream::get_resident() const
+{
+    int resident = 0;
+    for (int i = 0; i < SLOT_COUNT; i++) resident += m_slots[i].state == SLOT_RESIDENT;
+    return resident;
+}
+
+// ––––– SIMULATION THREAD ––––– //
+void LevelStream::update(float x, float y)
+{
+    if (m_file == NULL) return;
+
+    int chunk_x = chunk_column(x);
+    int chunk_y = chunk_row(y);
+
+    for (int i = 0; i < SLOT_COUNT; i++)
+    {
+        Slot &slot = m_slots[i];
+        if (slot.state == SLOT_FREE) continue;
+
+        int distance = std::max(abs(slot.chunk_x - chunk_x), abs(slot.chunk_y - chunk_y));
+        if (distance <= EVICT_RADIUS) continue;
+
+        // The loader owns a loading slot; it is freed once the load comes back
+        if (slot.state == SLOT_LOADING) slot.is_cancelled = true;
+        else                            evict(slot);
+    }
+
+    request_around(chunk_x, chunk_y);
+    install_next(false);
+}
+
+void LevelStream::load_around(float x, float y)
+{
+    if (m_file == NULL) return;
+
+    request_around(chunk_column(x), chunk_row(y));
+
+    bool is_loading = true;
+    while (is_loading)
+    {
+        is_loading = false;
+        for (int i = 0; i < SLOT_COUNT; i++) is_loading = is_loading || m_slots[i].state == SLOT_LOADING;
+
+        if (is_loading) install_next(true);
+    }
+}
+
+void LevelStream::request_around(int chunk_x, int chunk_y)
+{
+    for (int y = chunk_y - LOAD_RADIUS; y <= chunk_y + LOAD_RADIUS; y++)
+    {
+        if (y < 0 || y >= m_header.chunk_rows) continue;
+
+        for (int x = chunk_x - LOAD_RADIUS; x <= chunk_x + LOAD_RADIUS; x++)
+        {
+            if (x < 0 || x >= m_header.chunk_cols) continue;
+            request(x, y);
+        }
+    }
+}
+
+void LevelStream::request(int chunk_x, int chunk_y)
+{
+    int free_slot = -1;
+
+    for (int i = 0; i < SLOT_COUNT; i++)
+    {
+        Slot &slot = m_slots[i];
+
+        if (slot.state == SLOT_FREE)
+        {
+            if (free_slot < 0) free_slot = i;
+            continue;
+        }
+
+        if (slot.chunk_x == chunk_x && slot.chunk_y == chunk_y)
+        {
+            // Back in range before its load came back
+            slot.is_cancelled = false;
+            return;
+        }
+    }
+
+    // Cancelled loads can briefly hold every slot; the chunk is asked for again next tick
+    if (free_slot < 0) return;
+
+    Slot &slot = m_slots[free_slot];
+    slot.state        = SLOT_LOADING;
+    slot.is_cancelled = false;
+    slot.chunk_x      = chunk_x;
+    slot.chunk_y      = chunk_y;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests.push_back(free_slot);
+    }
+    m_wakeup.notify_one();
+}
+
+// Installs one loaded chunk, if there is one (with `wait`, once there is).
+// Returns whether a chunk was installed.
+bool LevelStream::install_next(bool wait)
+{
+    while (true)
+    {
+        int index;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (wait) m_chunk_loaded.wait(lock, [this] { return !m_loaded.empty(); });
+            if (m_loaded.empty()) return false;
+
+            index = m_loaded.front();
+            m_loaded.pop_front();
+        }
+
+        Slot &slot = m_slots[index];
+        if (slot.is_cancelled)
+        {
+            slot.state        = SLOT_FREE;
+            slot.is_cancelled = false;
+            if (wait) return false;
+            continue;
+        }
+
+        install(slot);
+        return true;
+    }
+}
+
+void LevelStream::install(Slot &slot)
+{
+    Uint64 start = SDL_GetPerformanceCounter();
+    bool no_win = false, no_loss = false;
+
+    for (int i = 0; i < slot.platform_count; i++)
+    {
+        const LevelPlatform &record = slot.staged[i];
+        EntityType type = record.type == LEVEL_TREASURE ? WIN_PLATFORM : LOSE_PLATFORM;
+
+        Entity &platform = slot.platforms[i];
+        platform = Entity();
+        platform.m_texture_id = m_texture_ids[type == WIN_PLATFORM ? 0 : 1];
+        platform.set_position(glm::vec3(record.x, record.y, 0.0f));
+        platform.set_width(record.width);
+        platform.set_height(record.height);
+        platform.set_entity_type(type);
+        platform.update(0.0f, NULL, 0, no_win, no_loss);
+        platform.set_size(glm::vec3(record.width, record.height, 1.0f));
+        platform.m_collision_mask = slot.has_mask[i] ? &slot.masks[i] : NULL;
+
+        slot.handles[i] = m_broadphase->insert(&platform);
+    }
+
+    slot.state = SLOT_RESIDENT;
+    m_chunks_loaded++;
+    m_max_resident = std::max(m_max_resident, get_resident());
+
+    double milliseconds = (SDL_GetPerformanceCounter() - start) * MILLISECONDS_PER_SECOND /
+                          SDL_GetPerformanceFrequency();
+    m_max_install_milliseconds = std::max(m_max_install_milliseconds, milliseconds);
+}
+
+void LevelStream::evict(Slot &slot)
+{
+    for (int i = 0; i < slot.platform_count; i++) m_broadphase->remove(slot.handles[i]);
+
+    slot.state          = SLOT_FREE;
+    slot.platform_count = 0;
+    m_chunks_evicted++;
+}
+
+// ––––– LOADER THREAD ––––– //
+void LevelStream::load_loop()
+{
+    while (true)
+    {
+        int index;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeup.wait(lock, [this] { return !m_is_running || !m_requests.empty(); });
+            if (!m_is_running) return;
+
+            index = m_requests.front();
+            m_requests.pop_front();
+        }
+
+        load_chunk(m_slots[index]);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_loaded.push_back(index);
+        }
+        m_chunk_loaded.notify_one();
+    }
+}
+
+void LevelStream::load_chunk(Slot &slot)
+{
+    const LevelChunkEntry &entry = m_chunks[(size_t) slot.chunk_y * m_header.chunk_cols + slot.chunk_x];
+    uint32_t first = entry.first_platform;
+    uint32_t count = entry.platform_count;
+
+    if (count > (uint32_t) MAX_PLATFORMS_PER_CHUNK || first > m_platform_total || count > m_platform_total - first)
+    {
+        LOG("Chunk " << slot.chunk_x << ", " << slot.chunk_y << " of the streamed level is damaged; leaving it empty.");
+        count = 0;
+    }
+
+    memcpy(slot.staged, m_platforms + first, count * sizeof(LevelPlatform));
+    slot.platform_count = (int) count;
+
+    // Masks are cut here too, so installing the chunk stays a few broadphase inserts
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const LevelPlatform &record     = slot.staged[i];
+        const CollisionMaskImage *image = m_mask_images[record.type == LEVEL_TREASURE ? 0 : 1];
+
+        slot.has_mask[i] = image != NULL && collision_mask_words(record.width, record.height) <= MAX_MASK_WORDS;
+        if (slot.has_mask[i])
+        {
+            build_collision_mask(*image, 0.0f, 0.0f, 1.0f, 1.0f, record.width, record.height,
+                                 slot.mask_words + i * MAX_MASK_WORDS, slot.masks[i]);
+        }
+    }
+
+    // Nothing reads these pages again until the chunk is next loaded
+    release_pages(&entry, sizeof(entry));
+    if (count > 0) release_pages(m_platforms + first, count * sizeof(LevelPlatform));
+}
+
+void LevelStream::release_pages(const void *start, size_t length)
+{
+#ifndef _WINDOWS
+    // Rounded outwards: the mapping is read-only, so a neighbouring chunk's
+    // dropped page just faults back in from the page cache on its next load
+    static const uintptr_t page_size = (uintptr_t) sysconf(_SC_PAGESIZE);
+
+    uintptr_t first = (uintptr_t) start & ~(page_size - 1);
+    uintptr_t last  = ((uintptr_t) start + length + page_size - 1) & ~(page_size - 1);
+    madvise((void *) first, last - first, MADV_DONTNEED);
+#endif
+}
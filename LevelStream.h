@@ -0,0 +1,168 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+class Arena;
+class Broadphase;
+class Entity;
+struct CollisionMask;
+struct CollisionMaskImage;
+
+// ––––– FILE FORMAT ––––– //
+// A streamed level is a single file: a header, a table with one entry per
+// chunk (row by row), then the platforms of every chunk, each chunk's
+// contiguous. Fields are 4 bytes, little-endian, so the file is read in place.
+const char     LEVEL_MAGIC[4]          = { 'L', 'V', 'L', 'C' };
+const uint32_t LEVEL_VERSION           = 1;
+const int      MAX_PLATFORMS_PER_CHUNK = 16;
+
+enum LevelPlatformType { LEVEL_TREASURE = 0, LEVEL_JELLYFISH = 1 };
+
+struct LevelHeader
+{
+    char magic[4];
+    uint32_t version;
+    float chunk_size;              // chunks are square, in world units
+    int32_t chunk_cols;
+    int32_t chunk_rows;
+    float origin_x, origin_y;      // bottom-left corner of chunk (0, 0)
+    float spawn_x, spawn_y;
+};
+
+struct LevelChunkEntry
+{
+    uint32_t first_platform;       // index into the platform records
+    uint32_t platform_count;
+};
+
+struct LevelPlatform
+{
+    float x, y, width, height;
+    uint32_t type;                 // LevelPlatformType
+};
+
+/**
+ * Streams a level's platforms in around the player, chunk by chunk, from a
+ * memory-mapped level file.
+ *
+ *  - Chunks within LOAD_RADIUS of the player's chunk are requested; chunks
+ *    further than EVICT_RADIUS away are dropped. The gap between the two
+ *    keeps a player hovering on a chunk border from loading and evicting
+ *    the same chunks every tick.
+ *  - A loader thread copies a requested chunk's records out of the mapping
+ *    into the chunk's slot, so the page faults that read the file never land
+ *    on the simulation thread. It then tells the kernel the pages can go,
+ *    which keeps the mapping from growing the process however far the player
+ *    travels.
+ *  - The loader also cuts each platform's collision mask from its texture's
+ *    mask image, into room the slot keeps for it.
+ *  - update() installs at most one loaded chunk per tick: it fills in that
+ *    chunk's entities and inserts them into the broadphase. Eviction removes
+ *    them again. Neither touches the file, so chunk borders cost the tick a
+ *    few broadphase inserts and nothing more.
+ *  - Every slot, with room for MAX_PLATFORMS_PER_CHUNK entities, comes from
+ *    the level arena up front. There are exactly enough slots for every chunk
+ *    within EVICT_RADIUS, so memory does not depend on the size of the level.
+ *
+ * Textures are not streamed: platforms use one texture per type, loaded with
+ * the level.
+ */
+class LevelStream
+{
+private:
+    static const int LOAD_RADIUS  = 1;   // in chunks
+    static const int EVICT_RADIUS = 2;
+    static const int SLOT_COUNT   = (2 * EVICT_RADIUS + 1) * (2 * EVICT_RADIUS + 1);
+    static const int MAX_MASK_WORDS = 64;   // per platform; bigger ones collide as boxes
+
+    enum SlotState { SLOT_FREE, SLOT_LOADING, SLOT_RESIDENT };
+
+    struct Slot
+    {
+        SlotState state = SLOT_FREE;
+        bool is_cancelled = false;   // evicted while the loader still had it
+        int chunk_x = 0, chunk_y = 0;
+        Entity *platforms = NULL;
+        int handles[MAX_PLATFORMS_PER_CHUNK];
+        LevelPlatform staged[MAX_PLATFORMS_PER_CHUNK];
+        CollisionMask *masks = NULL;
+        uint64_t *mask_words = NULL;
+        bool has_mask[MAX_PLATFORMS_PER_CHUNK];
+        int platform_count = 0;
+    };
+
+    // ––––– MAPPING ––––– //
+    const unsigned char *m_file = NULL;
+    size_t m_file_size = 0;
+    LevelHeader m_header;
+    const LevelChunkEntry *m_chunks = NULL;
+    const LevelPlatform *m_platforms = NULL;
+    uint32_t m_platform_total = 0;
+
+    Broadphase *m_broadphase = NULL;
+    unsigned int m_texture_ids[2] = { 0, 0 };   // win, lose
+    const CollisionMaskImage *m_mask_images[2] = { NULL, NULL };
+    Slot *m_slots = NULL;
+
+    // ––––– LOADER THREAD ––––– //
+    std::thread m_loader;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::condition_variable m_chunk_loaded;
+    std::deque<int> m_requests;   // slot indices
+    std::deque<int> m_loaded;
+    bool m_is_running = false;
+
+    // ––––– STATS ––––– //
+    int m_chunks_loaded   = 0;
+    int m_chunks_evicted  = 0;
+    int m_max_resident    = 0;
+    double m_max_install_milliseconds = 0.0;
+
+    void load_loop();
+    void load_chunk(Slot &slot);
+    void install(Slot &slot);
+    void evict(Slot &slot);
+    void request_around(int chunk_x, int chunk_y);
+    void request(int chunk_x, int chunk_y);
+    bool install_next(bool wait);
+    void release_pages(const void *start, size_t length);
+    static int chunk_index(float chunk, int count);
+    int chunk_column(float x) const;
+    int chunk_row(float y) const;
+
+public:
+    // ––––– METHODS ––––– //
+    ~LevelStream();
+
+    // Texture ids and mask images are the win and lose platforms'; a NULL
+    // mask image leaves those platforms colliding as boxes
+    bool initialise(const char *filepath, Arena &arena, Broadphase *broadphase, unsigned int win_texture_id,
+                    unsigned int lose_texture_id, const CollisionMaskImage *win_mask,
+                    const CollisionMaskImage *lose_mask);
+    // Slots and their entities belong to the level arena, and the streamed
+    // platforms stay in the broadphase: the caller clears both with the level
+    void shutdown();
+
+    // Call once per tick with the player's position
+    void update(float x, float y);
+
+    // Loads everything around a position before returning, for the level's
+    // first frame
+    void load_around(float x, float y);
+
+    // ––––– GETTERS ––––– //
+    bool  const is_open()      const { return m_file != NULL; };
+    float const get_min_x()    const;
+    float const get_min_y()    const;
+    float const get_max_x()    const;
+    float const get_max_y()    const;
+    float const get_spawn_x()  const { return m_header.spawn_x;  };
+    float const get_spawn_y()  const { return m_header.spawn_y;  };
+    int   const get_resident() const;
+};
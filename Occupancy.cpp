@@ -0,0 +1,135 @@
+#define GL_SILENCE_DEPRECATION
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <SDL.h>
+#include <SDL_opengl.h>
+#include "glm/mat4x4.hpp"
+#include "ShaderProgram.h"
+#include "Animation.h"
+#include "Entity.h"
+#include "Broadphase.h"
+#include "Terrain.h"
+#include "Occupancy.h"
+
+#define LOG(argument) std::cout << argument << '\n'
+
+const float INV_CELL_SIZE = 1.0f / OCCUPANCY_CELL_SIZE;
+const float HALF_WINDOW   = OCCUPANCY_SIZE * OCCUPANCY_CELL_SIZE * 0.5f;
+
+// Marks every cell the box overlaps. `left` and `top` are the window's
+// top-left corner in world units.
+static void stamp_box(uint8_t *plane, float left, float top, glm::vec2 min, glm::vec2 max)
+{
+    int first_col = std::max((int) std::floor((min.x - left) * INV_CELL_SIZE), 0);
+    int last_col  = std::min((int) std::ceil((max.x - left) * INV_CELL_SIZE), OCCUPANCY_SIZE);
+    int first_row = std::max((int) std::floor((top - max.y) * INV_CELL_SIZE), 0);
+    int last_row  = std::min((int) std::ceil((top - min.y) * INV_CELL_SIZE), OCCUPANCY_SIZE);
+    if (first_col >= last_col) return;
+
+    for (int row = first_row; row < last_row; row++)
+    {
+        memset(plane + row * OCCUPANCY_SIZE + first_col, 1, last_col - first_col);
+    }
+}
+
+void OccupancyRasterizer::set_terrain(const Terrain *terrain)
+{
+    m_terrain = terrain;
+    m_seabed.clear();
+    if (terrain == NULL) return;
+
+    int segment_count = terrain->get_segment_count();
+    m_seabed.resize(segment_count + 1);
+    for (int i = 0; i <= segment_count; i++) m_seabed[i] = terrain->sample(i);
+
+    m_seabed_x     = terrain->get_origin_x();
+    m_inv_spacing  = 1.0f / terrain->get_spacing();
+    m_seabed_end_x = m_seabed_x + segment_count * terrain->get_spacing();
+}
+
+// Marks, in each column, every cell reaching below the seabed, and whole
+// columns past either end of it
+void OccupancyRasterizer::stamp_walls(uint8_t *plane, float left, float top) const
+{
+    int segment_count = (int) m_seabed.size() - 1;
+
+    // A row is solid once its bottom edge is under the ground
+    uint8_t first_rows[OCCUPANCY_SIZE];
+    for (int col = 0; col < OCCUPANCY_SIZE; col++)
+    {
+        float x = left + (col + 0.5f) * OCCUPANCY_CELL_SIZE;
+        if (x < m_seabed_x || x > m_seabed_end_x)
+        {
+            first_rows[col] = 0;
+            continue;
+        }
+
+        // Terrain::get_height() from the table
+        float position = std::min((x - m_seabed_x) * m_inv_spacing, (float) segment_count);
+        int segment    = std::min((int) position, segment_count - 1);
+        float height   = m_seabed[segment] + (m_seabed[segment + 1] - m_seabed[segment]) * (position - segment);
+
+        // Clamped first, so truncating is flooring
+        float depth     = std::min(std::max((top - height) * INV_CELL_SIZE, 0.0f), (float) OCCUPANCY_SIZE);
+        first_rows[col] = (uint8_t) depth;
+    }
+
+    // Filled a row at a time, which the compiler can vectorise
+    for (int row = 0; row < OCCUPANCY_SIZE; row++)
+    {
+        uint8_t *cells = plane + row * OCCUPANCY_SIZE;
+        for (int col = 0; col < OCCUPANCY_SIZE; col++) cells[col] = row >= first_rows[col];
+    }
+}
+
+void OccupancyRasterizer::rasterize(Broadphase &broadphase, const float *centre_x, const float *centre_y,
+                                    int count, uint8_t *grids, size_t stride) const
+{
+    if ((uintptr_t) grids % OCCUPANCY_ALIGNMENT != 0 || stride % OCCUPANCY_ALIGNMENT != 0 ||
+        stride < OCCUPANCY_GRID_BYTES)
+    {
+        LOG("Occupancy grids have to start on " << OCCUPANCY_ALIGNMENT << "-byte boundaries, "
+            << OCCUPANCY_STRIDE << " or more bytes apart.");
+        assert(false);
+        return;   // nothing is written outside the caller's grids
+    }
+
+    Entity *nearby[MAX_OCCUPANCY_ENTITIES];
+
+    for (int i = 0; i < count; i++)
+    {
+        uint8_t *grid = grids + (size_t) i * stride;
+        memset(grid, 0, OCCUPANCY_GRID_BYTES);
+
+        glm::vec2 centre = glm::vec2(centre_x[i], centre_y[i]);
+        float left = centre.x - HALF_WINDOW;
+        float top  = centre.y + HALF_WINDOW;
+
+        int nearby_count = broadphase.query(centre - glm::vec2(HALF_WINDOW), centre + glm::vec2(HALF_WINDOW),
+                                            nearby, MAX_OCCUPANCY_ENTITIES);
+
+        for (int j = 0; j < nearby_count; j++)
+        {
+            EntityType type = nearby[j]->get_entity_type();
+            if (type != WIN_PLATFORM && type != LOSE_PLATFORM) continue;
+
+            int channel = type == WIN_PLATFORM ? OCCUPANCY_CHESTS : OCCUPANCY_JELLYFISH;
+
+            glm::vec3 position = nearby[j]->get_position();
+            glm::vec2 half     = glm::vec2(nearby[j]->get_width(), nearby[j]->get_height()) * 0.5f;
+            stamp_box(grid + channel * OCCUPANCY_PLANE_BYTES, left, top, glm::vec2(position) - half,
+                      glm::vec2(position) + half);
+        }
+
+        if (m_terrain != NULL) stamp_walls(grid + OCCUPANCY_WALLS * OCCUPANCY_PLANE_BYTES, left, top);
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Broadphase;
+class Terrain;
+
+/**
+ * Egocentric occupancy grids: a small top-down picture of what is around
+ * each lander, drawn on the CPU straight from the collision world rather
+ * than rendered through GL, for controllers that learn from images.
+ *
+ * A grid is OCCUPANCY_SIZE x OCCUPANCY_SIZE cells of OCCUPANCY_CELL_SIZE
+ * units, centred on the lander and axis aligned, with one plane of bytes per
+ * channel: 1 where something of that channel overlaps the cell, 0 elsewhere.
+ * Rows run top to bottom, like an image.
+ *
+ *     plane OCCUPANCY_CHESTS      win platforms
+ *     plane OCCUPANCY_JELLYFISH   lose platforms
+ *     plane OCCUPANCY_WALLS       the seabed, and either side of the level
+ *
+ * Platforms come from one broadphase query over each lander's window and are
+ * stamped as runs of whole rows. The seabed is filled from its height under
+ * each column's centre, read from a table of the terrain's samples taken
+ * when the terrain is set: working a sample out costs more than the rest of
+ * a grid, and every grid needs a few dozen.
+ *
+ * Grids go into memory the caller owns, such as the training bridge's shared
+ * region, one every `stride` bytes. The buffer and the stride both have to be
+ * multiples of OCCUPANCY_ALIGNMENT, so every grid starts on its own cache line
+ * and no two landers' grids share one.
+ */
+enum OccupancyChannel { OCCUPANCY_CHESTS, OCCUPANCY_JELLYFISH, OCCUPANCY_WALLS, OCCUPANCY_CHANNELS };
+
+const int    OCCUPANCY_SIZE         = 32;
+const float  OCCUPANCY_CELL_SIZE    = 0.25f;   // an 8 x 8 unit window, the lander 4 cells across
+const size_t OCCUPANCY_ALIGNMENT    = 64;
+const int    MAX_OCCUPANCY_ENTITIES = 64;      // platforms stamped per grid; any beyond are left out
+
+const size_t OCCUPANCY_PLANE_BYTES = OCCUPANCY_SIZE * OCCUPANCY_SIZE;
+const size_t OCCUPANCY_GRID_BYTES  = OCCUPANCY_CHANNELS * OCCUPANCY_PLANE_BYTES;
+
+// The smallest stride that keeps consecutive grids aligned
+const size_t OCCUPANCY_STRIDE = (OCCUPANCY_GRID_BYTES + OCCUPANCY_ALIGNMENT - 1) & ~(OCCUPANCY_ALIGNMENT - 1);
+
+class OccupancyRasterizer
+{
+private:
+    const Terrain *m_terrain = NULL;
+    std::vector<float> m_seabed;   // Terrain::sample() for every index
+    float m_seabed_x        = 0.0f;
+    float m_inv_spacing     = 1.0f;
+    float m_seabed_end_x    = 0.0f;
+
+    void stamp_walls(uint8_t *plane, float left, float top) const;
+
+public:
+    // ––––– METHODS ––––– //
+    // The level's seabed, or NULL for none. Set it again whenever the level
+    // changes, as with TerrainMesh.
+    void set_terrain(const Terrain *terrain);
+
+    // Fills `count` grids, one centred on each (centre_x[i], centre_y[i])
+    void rasterize(Broadphase &broadphase, const float *centre_x, const float *centre_y, int count, uint8_t *grids,
+                   size_t stride) const;
+};
@@ -0,0 +1,295 @@
+#define GL_SILENCE_DEPRECATION
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <algorithm>
+#include <cmath>
+#include <SDL.h>
+#include <SDL_opengl.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "glm/mat4x4.hpp"
+#include "ShaderProgram.h"
+#include "Animation.h"
+#include "Entity.h"
+#include "Broadphase.h"
+#include "Raycast.h"
+
+// Direction components are kept at least this far from zero, so every slab
+// distance is finite and a ray along an axis needs no special case
+const float MIN_DIRECTION = 1e-8f;
+const float FULL_TURN     = 6.28318531f;
+const int   PACKET_SIZE   = 4;
+
+// Four rays cast together. A short last group repeats its last ray in the
+// spare lanes.
+struct RaycastGrid::RayPacket
+{
+    float origin_x[PACKET_SIZE], origin_y[PACKET_SIZE];
+    float inverse_x[PACKET_SIZE], inverse_y[PACKET_SIZE];
+    float nearest[PACKET_SIZE];
+    int hit[PACKET_SIZE];   // box index, -1 for nothing
+};
+
+static float inverse_direction(float direction)
+{
+    if (std::fabs(direction) < MIN_DIRECTION) direction = direction < 0.0f ? -MIN_DIRECTION : MIN_DIRECTION;
+    return 1.0f / direction;
+}
+
+RaycastGrid::RaycastGrid(unsigned int type_mask)
+{
+    m_type_mask = type_mask;
+}
+
+// ––––– GRID ––––– //
+void RaycastGrid::rebuild(const Broadphase &broadphase)
+{
+    m_cell_size     = broadphase.get_cell_size();
+    m_inv_cell_size = 1.0f / m_cell_size;
+    m_version       = broadphase.get_version();
+    m_is_built      = true;
+
+    int count = broadphase.get_count();
+    std::vector<Entity*> entities(count);
+    std::vector<glm::vec2> mins(count), maxes(count);
+    broadphase.get_entries(entities.data(), mins.data(), maxes.data());
+
+    // Cell ranges of the boxes this grid sees, and the rectangle they cover
+    std::vector<int> ranges;
+    ranges.reserve((size_t) count * 4);
+    int min_x = 0, min_y = 0, max_x = -1, max_y = -1;
+    for (int i = 0; i < count; i++)
+    {
+        if (!(m_type_mask & ray_hits(entities[i]->get_entity_type())))
+        {
+            entities[i] = NULL;
+            continue;
+        }
+
+        int range[] = { (int) std::floor(mins[i].x  * m_inv_cell_size),
+                        (int) std::floor(mins[i].y  * m_inv_cell_size),
+                        (int) std::floor(maxes[i].x * m_inv_cell_size),
+                        (int) std::floor(maxes[i].y * m_inv_cell_size) };
+        bool is_first = max_x < min_x;
+        min_x = is_first ? range[0] : std::min(min_x, range[0]);
+        min_y = is_first ? range[1] : std::min(min_y, range[1]);
+        max_x = is_first ? range[2] : std::max(max_x, range[2]);
+        max_y = is_first ? range[3] : std::max(max_y, range[3]);
+        ranges.insert(ranges.end(), range, range + 4);
+    }
+
+    m_min_cell_x = min_x;
+    m_min_cell_y = min_y;
+    m_cols       = max_x - min_x + 1;
+    m_rows       = max_y - min_y + 1;
+
+    // Count each cell's boxes, turn the counts into starts, then fill the
+    // lists, each cell's start walking up to the next's as it goes
+    m_cell_starts.assign((size_t) m_cols * m_rows + 1, 0);
+    m_cell_stamps.assign((size_t) m_cols * m_rows, 0);
+    m_stamp = 0;
+    for (size_t box = 0; box < ranges.size(); box += 4)
+    {
+        for (int y = ranges[box + 1]; y <= ranges[box + 3]; y++)
+        {
+            for (int x = ranges[box]; x <= ranges[box + 2]; x++)
+            {
+                m_cell_starts[(y - min_y) * m_cols + (x - min_x) + 1]++;
+            }
+        }
+    }
+    for (size_t i = 1; i < m_cell_starts.size(); i++) m_cell_starts[i] += m_cell_starts[i - 1];
+
+    int slots = m_cell_starts.back();
+    m_min_x.resize(slots);
+    m_min_y.resize(slots);
+    m_max_x.resize(slots);
+    m_max_y.resize(slots);
+    m_entities.resize(slots);
+
+    std::vector<int> next(m_cell_starts.begin(), m_cell_starts.end() - 1);
+    size_t box = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (entities[i] == NULL) continue;
+
+        for (int y = ranges[box + 1]; y <= ranges[box + 3]; y++)
+        {
+            for (int x = ranges[box]; x <= ranges[box + 2]; x++)
+            {
+                int slot = next[(y - min_y) * m_cols + (x - min_x)]++;
+                m_min_x[slot]    = mins[i].x;
+                m_min_y[slot]    = mins[i].y;
+                m_max_x[slot]    = maxes[i].x;
+                m_max_y[slot]    = maxes[i].y;
+                m_entities[slot] = entities[i];
+            }
+        }
+        box += 4;
+    }
+}
+
+// ––––– CASTING ––––– //
+void RaycastGrid::test_boxes(int first, int last, RayPacket &packet) const
+{
+#if defined(__SSE2__)
+    // The four rays are the four lanes; each box is broadcast to all of them
+    const __m128 ray_x  = _mm_loadu_ps(packet.origin_x);
+    const __m128 ray_y  = _mm_loadu_ps(packet.origin_y);
+    const __m128 step_x = _mm_loadu_ps(packet.inverse_x);
+    const __m128 step_y = _mm_loadu_ps(packet.inverse_y);
+    const __m128 zero   = _mm_setzero_ps();
+
+    __m128  nearest = _mm_loadu_ps(packet.nearest);
+    __m128i hit     = _mm_loadu_si128((const __m128i *) packet.hit);
+
+    for (int i = first; i < last; i++)
+    {
+        __m128 near_x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(m_min_x[i]), ray_x), step_x);
+        __m128 far_x  = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(m_max_x[i]), ray_x), step_x);
+        __m128 near_y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(m_min_y[i]), ray_y), step_y);
+        __m128 far_y  = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(m_max_y[i]), ray_y), step_y);
+
+        __m128 enter = _mm_max_ps(_mm_max_ps(_mm_min_ps(near_x, far_x), _mm_min_ps(near_y, far_y)), zero);
+        __m128 exit  = _mm_min_ps(_mm_max_ps(near_x, far_x), _mm_max_ps(near_y, far_y));
+
+        __m128 is_hit = _mm_and_ps(_mm_cmple_ps(enter, exit), _mm_cmplt_ps(enter, nearest));
+        nearest = _mm_or_ps(_mm_and_ps(is_hit, enter), _mm_andnot_ps(is_hit, nearest));
+
+        __m128i hit_bits = _mm_castps_si128(is_hit);
+        hit = _mm_or_si128(_mm_and_si128(hit_bits, _mm_set1_epi32(i)), _mm_andnot_si128(hit_bits, hit));
+    }
+
+    _mm_storeu_ps(packet.nearest, nearest);
+    _mm_storeu_si128((__m128i *) packet.hit, hit);
+#else
+    for (int i = first; i < last; i++)
+    {
+        for (int lane = 0; lane < PACKET_SIZE; lane++)
+        {
+            float near_x = (m_min_x[i] - packet.origin_x[lane]) * packet.inverse_x[lane];
+            float far_x  = (m_max_x[i] - packet.origin_x[lane]) * packet.inverse_x[lane];
+            float near_y = (m_min_y[i] - packet.origin_y[lane]) * packet.inverse_y[lane];
+            float far_y  = (m_max_y[i] - packet.origin_y[lane]) * packet.inverse_y[lane];
+
+            float enter = std::max(std::max(std::min(near_x, far_x), std::min(near_y, far_y)), 0.0f);
+            float exit  = std::min(std::max(near_x, far_x), std::max(near_y, far_y));
+
+            if (enter <= exit && enter < packet.nearest[lane])
+            {
+                packet.nearest[lane] = enter;
+                packet.hit[lane]     = i;
+            }
+        }
+    }
+#endif
+}
+
+void RaycastGrid::cast(const Broadphase &broadphase, const RayBatch &rays, float max_distance, float *distances,
+                       Entity **hits)
+{
+    if (!m_is_built || m_version != broadphase.get_version()) rebuild(broadphase);
+
+    RayPacket packet;
+
+    for (int start = 0; start < rays.count; start += PACKET_SIZE)
+    {
+        int lanes = std::min(rays.count - start, PACKET_SIZE);
+
+        for (int lane = 0; lane < PACKET_SIZE; lane++)
+        {
+            int ray = start + std::min(lane, lanes - 1);
+            packet.origin_x[lane]  = rays.origin_x[ray];
+            packet.origin_y[lane]  = rays.origin_y[ray];
+            packet.inverse_x[lane] = inverse_direction(rays.direction_x[ray]);
+            packet.inverse_y[lane] = inverse_direction(rays.direction_y[ray]);
+            packet.nearest[lane]   = max_distance;
+            packet.hit[lane]       = -1;
+        }
+
+        // A stamp per group marks the cells it has already tested
+        if (++m_stamp == 0)
+        {
+            std::fill(m_cell_stamps.begin(), m_cell_stamps.end(), 0);
+            m_stamp = 1;
+        }
+
+        for (int lane = 0; lane < lanes; lane++)
+        {
+            float origin_x  = packet.origin_x[lane],  origin_y  = packet.origin_y[lane];
+            float inverse_x = packet.inverse_x[lane], inverse_y = packet.inverse_y[lane];
+            float end_x = origin_x + rays.direction_x[start + lane] * max_distance;
+            float end_y = origin_y + rays.direction_y[start + lane] * max_distance;
+
+            // Cells relative to the grid's corner; the walk may start or end
+            // outside it, where every cell is empty
+            int x = (int) std::floor(origin_x * m_inv_cell_size) - m_min_cell_x;
+            int y = (int) std::floor(origin_y * m_inv_cell_size) - m_min_cell_y;
+            int last_x = (int) std::floor(end_x * m_inv_cell_size) - m_min_cell_x;
+            int last_y = (int) std::floor(end_y * m_inv_cell_size) - m_min_cell_y;
+            int step_x = inverse_x > 0.0f ? 1 : -1, step_y = inverse_y > 0.0f ? 1 : -1;
+
+            // Distances along the ray to the next cell boundary on each axis
+            // and between boundaries, from the same reciprocals as the slabs
+            float boundary_x = (x + m_min_cell_x + (step_x > 0 ? 1 : 0)) * m_cell_size;
+            float boundary_y = (y + m_min_cell_y + (step_y > 0 ? 1 : 0)) * m_cell_size;
+            float next_x  = (boundary_x - origin_x) * inverse_x;
+            float next_y  = (boundary_y - origin_y) * inverse_y;
+            float every_x = m_cell_size * std::fabs(inverse_x);
+            float every_y = m_cell_size * std::fabs(inverse_y);
+
+            // Stepping exactly as many cells as lie between the ends keeps
+            // rounding from walking past the last one
+            int cells_left = std::abs(last_x - x) + std::abs(last_y - y);
+
+            for (;;)
+            {
+                if (x >= 0 && x < m_cols && y >= 0 && y < m_rows)
+                {
+                    int cell = y * m_cols + x;
+                    if (m_cell_stamps[cell] != m_stamp)
+                    {
+                        m_cell_stamps[cell] = m_stamp;
+                        test_boxes(m_cell_starts[cell], m_cell_starts[cell + 1], packet);
+                    }
+                }
+
+                // A box hit further on would be listed in the cell of the hit
+                if (cells_left-- == 0 || std::min(next_x, next_y) > packet.nearest[lane]) break;
+
+                if (next_x < next_y)
+                {
+                    x      += step_x;
+                    next_x += every_x;
+                }
+                else
+                {
+                    y      += step_y;
+                    next_y += every_y;
+                }
+            }
+        }
+
+        for (int lane = 0; lane < lanes; lane++)
+        {
+            distances[start + lane] = packet.nearest[lane];
+            if (hits != NULL) hits[start + lane] = packet.hit[lane] >= 0 ? m_entities[packet.hit[lane]] : NULL;
+        }
+    }
+}
+
+void ray_fan_directions(int ray_count, float *direction_x, float *direction_y)
+{
+    const float step = FULL_TURN / ray_count;
+
+    for (int i = 0; i < ray_count; i++)
+    {
+        direction_x[i] = std::cos(step * i);
+        direction_y[i] = std::sin(step * i);
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+
+class Broadphase;
+class Entity;
+
+// Type masks: bit n set lets rays hit EntityType n, so ray_hits(LOSE_PLATFORM)
+// sees only jellyfish
+const unsigned int RAY_HITS_ALL = ~0u;
+
+inline unsigned int ray_hits(int type)
+{
+    return 1u << type;
+}
+
+struct RayBatch
+{
+    const float *origin_x;
+    const float *origin_y;
+    const float *direction_x;   // unit length
+    const float *direction_y;
+    int count;
+};
+
+/**
+ * Range sensors against the collision world: how far each ray travels before
+ * it meets a platform's box, and which platform that was.
+ *
+ * The grid is a dense copy of the broadphase's: the same cells, but over the
+ * rectangle its entities cover, as one array of box lists back to back, so
+ * walking a ray through it (a grid DDA) is indexing rather than hashing. It is
+ * rebuilt whenever the broadphase has changed since the last cast, which for
+ * a streamed level is when a chunk comes or goes.
+ *
+ * Rays come in a batch of flat arrays and are cast four at a time. Each ray
+ * of a group walks its cells in order, and every box in a cell is slab-tested
+ * against all four rays together in SIMD; a cell another ray of the group
+ * already brought in is not tested again. A ray stops walking once its
+ * nearest hit is closer than the next cell. Rays laid out lander by lander, a
+ * fan from each origin, keep every group's rays close together, so they share
+ * most of their cells.
+ *
+ * Only platforms of the grid's types are seen: the seabed and other landers
+ * are not in the broadphase.
+ */
+class RaycastGrid
+{
+private:
+    struct RayPacket;
+
+    unsigned int m_type_mask;
+    unsigned int m_version = 0;
+    bool m_is_built        = false;
+
+    float m_cell_size     = 1.0f;
+    float m_inv_cell_size = 1.0f;
+    int m_min_cell_x = 0, m_min_cell_y = 0;
+    int m_cols = 0, m_rows = 0;
+
+    // Cell i's boxes are [m_cell_starts[i], m_cell_starts[i + 1]); a box is
+    // listed in every cell it overlaps
+    std::vector<int> m_cell_starts;
+    std::vector<float> m_min_x, m_min_y, m_max_x, m_max_y;
+    std::vector<Entity*> m_entities;
+    std::vector<unsigned int> m_cell_stamps;
+    unsigned int m_stamp = 0;
+
+    void rebuild(const Broadphase &broadphase);
+    void test_boxes(int first, int last, RayPacket &packet) const;
+
+public:
+    // ––––– METHODS ––––– //
+    explicit RaycastGrid(unsigned int type_mask = RAY_HITS_ALL);
+
+    // Writes each ray's distance to the nearest box (`max_distance`, which has
+    // to be finite, when there is none within reach) and, if `hits` is not
+    // NULL, what it hit (NULL when nothing). A ray starting inside a box hits
+    // it at 0.
+    void cast(const Broadphase &broadphase, const RayBatch &rays, float max_distance, float *distances,
+              Entity **hits);
+
+    // ––––– GETTERS ––––– //
+    int const get_cell_count() const { return m_cols * m_rows;         };
+    int const get_box_count()  const { return (int) m_entities.size(); };
+};
+
+// `ray_count` unit directions evenly spaced around the circle, the first
+// along +x and the rest anticlockwise
+void ray_fan_directions(int ray_count, float *direction_x, float *direction_y);
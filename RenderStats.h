@@ -0,0 +1,36 @@
+#pragma once
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+
+/**
+ * Draw calls and vertices submitted since the last reset_render_stats().
+ * Every draw in the game goes through draw_arrays() so the counts are
+ * complete; the golden-image harness reports them per frame.
+ */
+struct RenderStats
+{
+    int draw_calls = 0;
+    int vertices   = 0;
+};
+
+inline RenderStats &render_stats()
+{
+    static RenderStats stats;
+    return stats;
+}
+
+inline void reset_render_stats()
+{
+    render_stats() = RenderStats();
+}
+
+inline void draw_arrays(GLenum mode, GLint first, GLsizei count)
+{
+    render_stats().draw_calls++;
+    render_stats().vertices += count;
+    glDrawArrays(mode, first, count);
+}
@@ -1,26 +1,171 @@
 #define GL_SILENCE_DEPRECATION
 
+#include <SDL.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
 #include "ShaderProgram.h"
+#include "Hash.h"
+
+// Program binaries are core in GL 4.1 / ES 3.0 and otherwise come from
+// ARB_get_program_binary, so the entry points are looked up at runtime
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void (APIENTRY *GetProgramBinaryFunction)(GLuint, GLsizei, GLsizei *, GLenum *, void *);
+typedef void (APIENTRY *ProgramBinaryFunction)(GLuint, GLenum, const void *, GLsizei);
+typedef void (APIENTRY *ProgramParameteriFunction)(GLuint, GLenum, GLint);
+
+static GetProgramBinaryFunction getProgramBinary = NULL;
+static ProgramBinaryFunction programBinary = NULL;
+static ProgramParameteriFunction programParameteri = NULL;
+
+static bool ProgramBinariesSupported() {
+    static int supported = -1;
+    
+    if (supported < 0) {
+        getProgramBinary = (GetProgramBinaryFunction) SDL_GL_GetProcAddress("glGetProgramBinary");
+        programBinary = (ProgramBinaryFunction) SDL_GL_GetProcAddress("glProgramBinary");
+        programParameteri = (ProgramParameteriFunction) SDL_GL_GetProcAddress("glProgramParameteri");
+        
+        // Some drivers export the functions but offer no binary formats
+        GLint formats = 0;
+        if (getProgramBinary != NULL && programBinary != NULL && programParameteri != NULL) {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        }
+        supported = formats > 0 ? 1 : 0;
+    }
+    
+    return supported == 1;
+}
+
+static uint64_t Hash(const std::string &text, uint64_t hash = HASH_OFFSET_BASIS) {
+    return hash_bytes(text.data(), text.size(), hash);
+}
+
+static uint64_t DriverHash() {
+    std::string driver;
+    const GLubyte *strings[] = { glGetString(GL_VENDOR), glGetString(GL_RENDERER), glGetString(GL_VERSION) };
+    for (const GLubyte *string : strings) {
+        if (string != NULL) driver += (const char *) string;
+        driver += '\n';
+    }
+    return Hash(driver);
+}
+
+struct ProgramBinaryHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceHash;
+    uint64_t driverHash;
+    uint32_t format;
+    uint32_t length;
+};
+
+static const char PROGRAM_BINARY_MAGIC[4] = { 'L', 'L', 'P', 'B' };
+static const uint32_t PROGRAM_BINARY_VERSION = 1;
 
 void ShaderProgram::Load(const char *vertexShaderFile, const char *fragmentShaderFile) {
     
-    // create the vertex shader
-    vertexShader = LoadShaderFromFile(vertexShaderFile, GL_VERTEX_SHADER);
-    // create the fragment shader
-    fragmentShader = LoadShaderFromFile(fragmentShaderFile, GL_FRAGMENT_SHADER);
+    // remember where the sources live so the program can be rebuilt later
+    vertexShaderPath = vertexShaderFile;
+    fragmentShaderPath = fragmentShaderFile;
+    
+    std::string vertexSource = ReadShaderFile(vertexShaderFile);
+    std::string fragmentSource = ReadShaderFile(fragmentShaderFile);
+    uint64_t sourceHash = Hash(fragmentSource, Hash(vertexSource));
+    
+    // A cached binary for these exact sources on this exact driver skips
+    // compiling and linking altogether
+    programID = LoadCachedProgram(sourceHash);
+    
+    if (programID != 0) {
+        vertexShader = 0;
+        fragmentShader = 0;
+    } else {
+        // create the vertex shader
+        vertexShader = LoadShaderFromString(vertexSource, GL_VERTEX_SHADER);
+        // create the fragment shader
+        fragmentShader = LoadShaderFromString(fragmentSource, GL_FRAGMENT_SHADER);
+        
+        // Create the final shader program from our vertex and fragment shaders
+        programID = LinkProgram(vertexShader, fragmentShader);
+        StoreCachedProgram(programID, sourceHash);
+    }
+    
+    LookupLocations();
+	
+	SetColor(1.0f, 1.0f, 1.0f, 1.0f);
+    
+}
+
+bool ShaderProgram::Reload() {
+    
+    std::string vertexSource = ReadShaderFile(vertexShaderPath);
+    std::string fragmentSource = ReadShaderFile(fragmentShaderPath);
+    
+    // Build the replacement next to the live program...
+    GLuint newVertexShader = LoadShaderFromString(vertexSource, GL_VERTEX_SHADER);
+    GLuint newFragmentShader = LoadShaderFromString(fragmentSource, GL_FRAGMENT_SHADER);
+    GLuint newProgramID = LinkProgram(newVertexShader, newFragmentShader);
+    
+    GLint linkSuccess;
+    glGetProgramiv(newProgramID, GL_LINK_STATUS, &linkSuccess);
+    
+    // ...and keep drawing with the old one if it does not link
+    if(linkSuccess == GL_FALSE) {
+        glDeleteProgram(newProgramID);
+        glDeleteShader(newVertexShader);
+        glDeleteShader(newFragmentShader);
+        return false;
+    }
+    
+    Cleanup();
+    
+    programID = newProgramID;
+    vertexShader = newVertexShader;
+    fragmentShader = newFragmentShader;
+    
+    StoreCachedProgram(programID, Hash(fragmentSource, Hash(vertexSource)));
+    LookupLocations();
+    
+    // Uniform values do not carry over to a new program; callers have to
+    // set the projection and view matrices again
+    SetColor(1.0f, 1.0f, 1.0f, 1.0f);
+    
+    return true;
+}
+
+GLuint ShaderProgram::LinkProgram(GLuint vertex, GLuint fragment) {
     
-    // Create the final shader program from our vertex and fragment shaders
-    programID = glCreateProgram();
-    glAttachShader(programID, vertexShader);
-    glAttachShader(programID, fragmentShader);
-    glLinkProgram(programID);
+    GLuint program = glCreateProgram();
+    if (!binaryCacheDirectory.empty() && ProgramBinariesSupported()) {
+        programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
     
     GLint linkSuccess;
-    glGetProgramiv(programID, GL_LINK_STATUS, &linkSuccess);
+    glGetProgramiv(program, GL_LINK_STATUS, &linkSuccess);
     if(linkSuccess == GL_FALSE) {
-	printf("Error linking shader program!\n");
+        GLchar messages[512];
+        glGetProgramInfoLog(program, sizeof(messages), 0, &messages[0]);
+	printf("Error linking shader program!\n%s\n", messages);
     }
     
+    return program;
+}
+
+void ShaderProgram::LookupLocations() {
+    
     modelMatrixUniform = glGetUniformLocation(programID, "modelMatrix");
     projectionMatrixUniform = glGetUniformLocation(programID, "projectionMatrix");
     viewMatrixUniform = glGetUniformLocation(programID, "viewMatrix");
@@ -28,9 +173,6 @@ void ShaderProgram::Load(const char *vertexShaderFile, const char *fragmentShade
     
     positionAttribute = glGetAttribLocation(programID, "position");
     texCoordAttribute = glGetAttribLocation(programID, "texCoord");
-	
-	SetColor(1.0f, 1.0f, 1.0f, 1.0f);
-    
 }
 
 void ShaderProgram::Cleanup() {
@@ -39,7 +181,7 @@ void ShaderProgram::Cleanup() {
     glDeleteShader(fragmentShader);
 }
 
-GLuint ShaderProgram::LoadShaderFromFile(const std::string &shaderFile, GLenum type) {
+std::string ShaderProgram::ReadShaderFile(const std::string &shaderFile) {
     //Open a file stream with the file name
     std::ifstream infile(shaderFile);
     
@@ -51,8 +193,12 @@ GLuint ShaderProgram::LoadShaderFromFile(const std::string &shaderFile, GLenum t
     std::stringstream buffer;
     buffer << infile.rdbuf();
     
+    return buffer.str();
+}
+
+GLuint ShaderProgram::LoadShaderFromFile(const std::string &shaderFile, GLenum type) {
     // Load the shader from the contents of the file
-    return LoadShaderFromString(buffer.str(), type);
+    return LoadShaderFromString(ReadShaderFile(shaderFile), type);
 }
 
 GLuint ShaderProgram::LoadShaderFromString(const std::string &shaderContents, GLenum type) {
@@ -103,3 +249,95 @@ void ShaderProgram::SetProjectionMatrix(const glm::mat4 &matrix) {
     glUseProgram(programID);
     glUniformMatrix4fv(projectionMatrixUniform, 1, GL_FALSE, &matrix[0][0]);    
 }
+
+std::string ShaderProgram::CachedProgramPath(uint64_t sourceHash) {
+    char name[32];
+    snprintf(name, sizeof(name), "program_%016llx.bin", (unsigned long long) sourceHash);
+    return binaryCacheDirectory + name;
+}
+
+GLuint ShaderProgram::LoadCachedProgram(uint64_t sourceHash) {
+    if (binaryCacheDirectory.empty() || !ProgramBinariesSupported()) return 0;
+    
+    std::ifstream infile(CachedProgramPath(sourceHash), std::ios::binary);
+    if (infile.fail()) return 0;
+    
+    ProgramBinaryHeader header;
+    if (!infile.read((char *) &header, sizeof(header))) return 0;
+    
+    // Binaries are only valid for the driver build that produced them
+    if (memcmp(header.magic, PROGRAM_BINARY_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != PROGRAM_BINARY_VERSION ||
+        header.sourceHash != sourceHash ||
+        header.driverHash != DriverHash()) {
+        return 0;
+    }
+    
+    // A corrupt length must not turn into a huge allocation; the binary is
+    // everything after the header
+    std::streampos start = infile.tellg();
+    infile.seekg(0, std::ios::end);
+    std::streamoff remaining = infile.tellg() - start;
+    infile.seekg(start);
+    if (header.length == 0 || (std::streamoff) header.length > remaining) return 0;
+    
+    std::vector<char> binary(header.length);
+    if (!infile.read(binary.data(), header.length)) return 0;
+    
+    GLuint program = glCreateProgram();
+    programBinary(program, header.format, binary.data(), (GLsizei) header.length);
+    
+    // The driver may still reject it (e.g. after an update that kept the
+    // version string); fall back to compiling from source
+    GLint linkSuccess;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkSuccess);
+    if (linkSuccess == GL_FALSE) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    
+    return program;
+}
+
+void ShaderProgram::StoreCachedProgram(GLuint program, uint64_t sourceHash) {
+    if (binaryCacheDirectory.empty() || !ProgramBinariesSupported()) return;
+    
+    GLint linkSuccess;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkSuccess);
+    if (linkSuccess == GL_FALSE) return;
+    
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    getProgramBinary(program, length, &length, &format, binary.data());
+    
+    ProgramBinaryHeader header;
+    memcpy(header.magic, PROGRAM_BINARY_MAGIC, sizeof(header.magic));
+    header.version = PROGRAM_BINARY_VERSION;
+    header.sourceHash = sourceHash;
+    header.driverHash = DriverHash();
+    header.format = format;
+    header.length = (uint32_t) length;
+    
+    // Written beside the cache file and renamed over it, so a crash or a
+    // second instance never leaves a half-written binary under the real name
+    std::string path = CachedProgramPath(sourceHash);
+    std::string temporaryPath = path + ".tmp";
+    
+    std::ofstream outfile(temporaryPath, std::ios::binary | std::ios::trunc);
+    outfile.write((const char *) &header, sizeof(header));
+    outfile.write(binary.data(), length);
+    outfile.close();
+    
+    // Windows will not rename over an existing file
+    bool isWritten = !outfile.fail();
+    if (isWritten && rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        remove(path.c_str());
+        isWritten = rename(temporaryPath.c_str(), path.c_str()) == 0;
+    }
+    
+    if (!isWritten) remove(temporaryPath.c_str());
+}
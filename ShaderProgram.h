@@ -5,6 +5,7 @@
 #endif
 #define GL_GLEXT_PROTOTYPES 1
 #include <SDL_opengl.h>
+#include <cstdint>
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -15,6 +16,7 @@ class ShaderProgram {
     public:
 	
 		void Load(const char *vertexShaderFile, const char *fragmentShaderFile);
+		bool Reload();
 		void Cleanup();
 
 		void SetModelMatrix(const glm::mat4 &matrix);
@@ -38,4 +40,20 @@ class ShaderProgram {
     
         GLuint vertexShader;
         GLuint fragmentShader;
+    
+        std::string vertexShaderPath;
+        std::string fragmentShaderPath;
+    
+        // Where linked program binaries are cached between runs (with a
+        // trailing separator). Leave empty to always compile from source.
+        std::string binaryCacheDirectory;
+    
+    private:
+        std::string ReadShaderFile(const std::string &shaderFile);
+        GLuint LinkProgram(GLuint vertex, GLuint fragment);
+        void LookupLocations();
+    
+        GLuint LoadCachedProgram(uint64_t sourceHash);
+        void StoreCachedProgram(GLuint program, uint64_t sourceHash);
+        std::string CachedProgramPath(uint64_t sourceHash);
 };
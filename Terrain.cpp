@@ -0,0 +1,275 @@
+#define GL_SILENCE_DEPRECATION
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "glm/mat4x4.hpp"
+#include "RenderStats.h"
+#include "Terrain.h"
+
+const int   SWELL_PERIOD  = 48;     // in samples
+const int   RIPPLE_PERIOD = 7;
+const float SWELL_WEIGHT  = 0.75f;
+const float RIPPLE_WEIGHT = 0.25f;
+
+// Sand, light on the surface and darker towards the floor
+const unsigned char SAND_PIXELS[] = { 214, 190, 128, 255,
+                                       96,  80,  52, 255 };
+const float SURFACE_V = 0.25f,   // texel centres, so the gradient spans the whole strip
+            FLOOR_V   = 0.75f;
+
+// ––––– TERRAIN ––––– //
+Terrain::Terrain(float origin_x, float length, float spacing, float base_y, float amplitude, float floor_y,
+                 uint32_t seed)
+{
+    m_origin_x      = origin_x;
+    m_spacing       = spacing;
+    m_inv_spacing   = 1.0f / spacing;
+    m_segment_count = std::max((int) std::ceil(length * m_inv_spacing), 1);
+    m_base_y        = base_y;
+    m_amplitude     = amplitude;
+    m_floor_y       = floor_y;
+    m_seed          = seed;
+}
+
+float Terrain::lattice(int point, uint32_t seed)
+{
+    uint32_t hash = (uint32_t) point * 0x27d4eb2du ^ seed;
+    hash ^= hash >> 15;
+    hash *= 0x2c1b3c6du;
+    hash ^= hash >> 12;
+    hash *= 0x297a2d39u;
+    hash ^= hash >> 15;
+
+    return (hash & 0xffffff) / 16777216.0f;
+}
+
+float Terrain::smooth_noise(int index, int period, uint32_t seed)
+{
+    // Indices are never negative, so division is floor
+    int cell = index / period;
+    float t  = (float) (index - cell * period) / period;
+    t        = t * t * (3.0f - 2.0f * t);
+
+    float from = lattice(cell, seed);
+    return from + (lattice(cell + 1, seed) - from) * t;
+}
+
+float Terrain::sample(int index) const
+{
+    index = std::min(std::max(index, 0), m_segment_count);
+
+    float swell  = smooth_noise(index, SWELL_PERIOD, m_seed);
+    float ripple = smooth_noise(index, RIPPLE_PERIOD, m_seed ^ 0x9e3779b9u);
+
+    return m_base_y + m_amplitude * (SWELL_WEIGHT * (2.0f * swell - 1.0f) + RIPPLE_WEIGHT * (2.0f * ripple - 1.0f));
+}
+
+float Terrain::get_height(float x) const
+{
+    float position = std::min(std::max((x - m_origin_x) * m_inv_spacing, 0.0f), (float) m_segment_count);
+    int segment    = std::min((int) position, m_segment_count - 1);
+    float t        = position - segment;
+
+    float from = sample(segment);
+    return from + (sample(segment + 1) - from) * t;
+}
+
+bool Terrain::get_ground(float min_x, float max_x, float &ground) const
+{
+    float end_x = m_origin_x + m_segment_count * m_spacing;
+    // Written so NaN fails too, before it reaches the casts below
+    if (!(max_x >= m_origin_x && min_x <= end_x)) return false;
+
+    int first = std::max((int) std::floor((min_x - m_origin_x) * m_inv_spacing), 0);
+    int last  = std::min((int) std::floor((max_x - m_origin_x) * m_inv_spacing), m_segment_count - 1);
+    if (first > last) return false;   // touching only the far end, or an empty range
+
+    float highest = -FLT_MAX;
+
+    // Heights for a pass of segments, then each segment clipped to the box:
+    // a straight segment is highest at one end of whatever part of it lies
+    // under the box, so two lerps per segment find it
+    float heights[MAX_QUERY_SEGMENTS + 1];
+
+    for (int start = first; start <= last; start += MAX_QUERY_SEGMENTS)
+    {
+        int count = std::min(last - start + 1, MAX_QUERY_SEGMENTS);
+        for (int i = 0; i <= count; i++) heights[i] = sample(start + i);
+
+        float start_x = m_origin_x + start * m_spacing;
+        int i = 0;
+
+#if defined(__SSE2__)
+        const __m128 zero     = _mm_setzero_ps();
+        const __m128 one      = _mm_set1_ps(1.0f);
+        const __m128 inv_step = _mm_set1_ps(m_inv_spacing);
+        const __m128 box_min  = _mm_set1_ps(min_x);
+        const __m128 box_max  = _mm_set1_ps(max_x);
+        const __m128 lanes    = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        __m128 highest_lanes  = _mm_set1_ps(-FLT_MAX);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 left_x = _mm_add_ps(_mm_set1_ps(start_x + i * m_spacing),
+                                       _mm_mul_ps(lanes, _mm_set1_ps(m_spacing)));
+            __m128 left_y  = _mm_loadu_ps(heights + i);
+            __m128 right_y = _mm_loadu_ps(heights + i + 1);
+            __m128 rise    = _mm_sub_ps(right_y, left_y);
+
+            // Where the box's edges fall along each segment, 0 to 1
+            __m128 t_min = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(box_min, left_x), inv_step), zero), one);
+            __m128 t_max = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(box_max, left_x), inv_step), zero), one);
+
+            __m128 y_min = _mm_add_ps(left_y, _mm_mul_ps(rise, t_min));
+            __m128 y_max = _mm_add_ps(left_y, _mm_mul_ps(rise, t_max));
+
+            highest_lanes = _mm_max_ps(highest_lanes, _mm_max_ps(y_min, y_max));
+        }
+
+        alignas(16) float lane_highest[4];
+        _mm_store_ps(lane_highest, highest_lanes);
+        for (int lane = 0; lane < 4; lane++) highest = std::max(highest, lane_highest[lane]);
+#endif
+
+        for (; i < count; i++)
+        {
+            float left_x = start_x + i * m_spacing;
+            float rise   = heights[i + 1] - heights[i];
+            float t_min  = std::min(std::max((min_x - left_x) * m_inv_spacing, 0.0f), 1.0f);
+            float t_max  = std::min(std::max((max_x - left_x) * m_inv_spacing, 0.0f), 1.0f);
+
+            highest = std::max(highest, std::max(heights[i] + rise * t_min, heights[i] + rise * t_max));
+        }
+    }
+
+    ground = highest;
+    return true;
+}
+
+// ––––– TERRAIN MESH ––––– //
+void TerrainMesh::initialise()
+{
+    glGenTextures(1, &m_texture_id);
+    glBindTexture(GL_TEXTURE_2D, m_texture_id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, SAND_PIXELS);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void TerrainMesh::shutdown()
+{
+    for (CachedChunk &chunk : m_chunks)
+    {
+        if (chunk.vertex_buffer != 0) glDeleteBuffers(1, &chunk.vertex_buffer);
+        chunk = CachedChunk();
+    }
+
+    if (m_texture_id != 0) glDeleteTextures(1, &m_texture_id);
+    m_texture_id = 0;
+    m_terrain    = NULL;
+}
+
+void TerrainMesh::set_terrain(const Terrain *terrain)
+{
+    m_terrain = terrain;
+
+    // Buffers are kept for the next terrain's chunks to be built into
+    for (CachedChunk &chunk : m_chunks) chunk.index = -1;
+}
+
+void TerrainMesh::build(CachedChunk &chunk, int index)
+{
+    int first = index * Terrain::SEGMENTS_PER_CHUNK;
+    int count = std::min(Terrain::SEGMENTS_PER_CHUNK, m_terrain->get_segment_count() - first);
+
+    // Surface and floor vertex for every sample, left to right
+    float vertices[VERTICES_PER_CHUNK * FLOATS_PER_VERTEX];
+    float *vertex = vertices;
+
+    for (int i = 0; i <= count; i++)
+    {
+        float x = m_terrain->get_origin_x() + (first + i) * m_terrain->get_spacing();
+
+        *vertex++ = x;
+        *vertex++ = m_terrain->sample(first + i);
+        *vertex++ = 0.5f;
+        *vertex++ = SURFACE_V;
+
+        *vertex++ = x;
+        *vertex++ = m_terrain->get_floor_y();
+        *vertex++ = 0.5f;
+        *vertex++ = FLOOR_V;
+    }
+
+    chunk.index        = index;
+    chunk.vertex_count = 2 * (count + 1);
+
+    if (chunk.vertex_buffer == 0) glGenBuffers(1, &chunk.vertex_buffer);
+
+    glBindBuffer(GL_ARRAY_BUFFER, chunk.vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, chunk.vertex_count * FLOATS_PER_VERTEX * sizeof(float), vertices, GL_STATIC_DRAW);
+
+    m_builds++;
+}
+
+TerrainMesh::CachedChunk &TerrainMesh::find_or_build(int index)
+{
+    CachedChunk *oldest = &m_chunks[0];
+
+    for (CachedChunk &chunk : m_chunks)
+    {
+        if (chunk.index == index)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, chunk.vertex_buffer);
+            return chunk;
+        }
+
+        if (chunk.last_drawn < oldest->last_drawn) oldest = &chunk;
+    }
+
+    build(*oldest, index);
+    return *oldest;
+}
+
+void TerrainMesh::render(ShaderProgram *program, float min_x, float max_x)
+{
+    if (m_terrain == NULL) return;
+    m_frame++;
+
+    float chunk_width = Terrain::SEGMENTS_PER_CHUNK * m_terrain->get_spacing();
+    int first = std::max((int) std::floor((min_x - m_terrain->get_origin_x()) / chunk_width), 0);
+    int last  = std::min((int) std::floor((max_x - m_terrain->get_origin_x()) / chunk_width),
+                         m_terrain->get_chunk_count() - 1);
+    if (first > last) return;
+
+    // Vertices are already in world space
+    program->SetModelMatrix(glm::mat4(1.0f));
+    glBindTexture(GL_TEXTURE_2D, m_texture_id);
+
+    GLsizei stride = FLOATS_PER_VERTEX * sizeof(float);
+
+    for (int index = first; index <= last; index++)
+    {
+        CachedChunk &chunk = find_or_build(index);
+        chunk.last_drawn   = m_frame;
+
+        glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, stride, (void *) 0);
+        glEnableVertexAttribArray(program->positionAttribute);
+        glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, stride, (void *) (2 * sizeof(float)));
+        glEnableVertexAttribArray(program->texCoordAttribute);
+
+        draw_arrays(GL_TRIANGLE_STRIP, 0, chunk.vertex_count);
+    }
+
+    glDisableVertexAttribArray(program->positionAttribute);
+    glDisableVertexAttribArray(program->texCoordAttribute);
+
+    // Everything else still draws from client-side arrays
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+#include <cstdint>
+#include "ShaderProgram.h"
+
+/**
+ * The seabed: a polyline with one height every `spacing` units along x,
+ * solid all the way down from the line.
+ *
+ * Heights are a fixed function of the sample index (two octaves of value
+ * noise), so nothing is stored and any stretch of seabed can be recomputed
+ * wherever it is needed, on whichever thread. That keeps a Terrain immutable
+ * once built: the simulation collides with it while the renderer draws it.
+ *
+ * get_ground() only looks at the segments under the box it is given, four
+ * segments at a time in SIMD where SSE2 is available.
+ */
+class Terrain
+{
+public:
+    static const int SEGMENTS_PER_CHUNK = 64;    // drawing unit for TerrainMesh
+    static const int MAX_QUERY_SEGMENTS = 64;    // heights evaluated per pass in get_ground()
+
+private:
+    float m_origin_x;
+    float m_spacing;
+    float m_inv_spacing;
+    int m_segment_count;
+    float m_base_y;
+    float m_amplitude;
+    float m_floor_y;
+    uint32_t m_seed;
+
+    static float lattice(int point, uint32_t seed);
+    static float smooth_noise(int index, int period, uint32_t seed);
+
+public:
+    // ––––– METHODS ––––– //
+    // Spans [origin_x, origin_x + length]; heights stay within `amplitude`
+    // of `base_y`. The floor is only where drawing stops.
+    Terrain(float origin_x, float length, float spacing, float base_y, float amplitude, float floor_y, uint32_t seed);
+
+    // Height of sample `index`, 0 to get_segment_count()
+    float sample(int index) const;
+
+    // Height of the seabed at x, held level past either end
+    float get_height(float x) const;
+
+    // Highest point of the seabed anywhere over [min_x, max_x]. Returns false
+    // if the range misses the terrain altogether.
+    bool get_ground(float min_x, float max_x, float &ground) const;
+
+    // ––––– GETTERS ––––– //
+    float const get_origin_x()      const { return m_origin_x;      };
+    float const get_spacing()       const { return m_spacing;       };
+    float const get_floor_y()       const { return m_floor_y;       };
+    int   const get_segment_count() const { return m_segment_count; };
+    int   const get_chunk_count()   const { return (m_segment_count + SEGMENTS_PER_CHUNK - 1) / SEGMENTS_PER_CHUNK; };
+};
+
+/**
+ * Draws a Terrain as triangle strips from the seabed line down to its floor,
+ * one strip and one vertex buffer per chunk of SEGMENTS_PER_CHUNK segments.
+ *
+ * A chunk's buffer is filled once, the first time the chunk comes into view,
+ * and kept while it stays in the small cache; after that drawing it is one
+ * bind and one glDrawArrays. Main thread only, like everything else in GL.
+ */
+class TerrainMesh
+{
+private:
+    static const int CACHED_CHUNKS      = 4;    // a chunk is wider than the view, so two are ever on screen
+    static const int VERTICES_PER_CHUNK = 2 * (Terrain::SEGMENTS_PER_CHUNK + 1);
+    static const int FLOATS_PER_VERTEX  = 4;    // x, y, u, v
+
+    struct CachedChunk
+    {
+        int index               = -1;
+        GLuint vertex_buffer    = 0;
+        int vertex_count        = 0;
+        unsigned int last_drawn = 0;
+    };
+
+    const Terrain *m_terrain = NULL;
+    GLuint m_texture_id      = 0;
+    CachedChunk m_chunks[CACHED_CHUNKS];
+    unsigned int m_frame = 0;
+    int m_builds         = 0;
+
+    CachedChunk &find_or_build(int index);
+    void build(CachedChunk &chunk, int index);
+
+public:
+    // ––––– METHODS ––––– //
+    void initialise();
+    void shutdown();
+
+    // Cached chunks belong to the previous terrain; NULL draws nothing
+    void set_terrain(const Terrain *terrain);
+
+    // Draws the chunks overlapping [min_x, max_x] in world space
+    void render(ShaderProgram *program, float min_x, float max_x);
+
+    // ––––– GETTERS ––––– //
+    int const get_builds() const { return m_builds; };
+};
@@ -0,0 +1,130 @@
+#define GL_SILENCE_DEPRECATION
+
+#include <cstring>
+#include "RenderStats.h"
+#include "TextBatch.h"
+
+// Each glyph is two triangles of four floats per vertex: x, y, u, v
+const int FLOATS_PER_VERTEX = 4;
+const int VERTICES_PER_GLYPH = 6;
+
+TextBatch::TextBatch(GLuint font_texture_id)
+{
+    m_font_texture_id = font_texture_id;
+}
+
+TextBatch::~TextBatch()
+{
+    if (m_vertex_buffer != 0) glDeleteBuffers(1, &m_vertex_buffer);
+}
+
+int TextBatch::add_span(glm::vec3 position, float size, float spacing)
+{
+    Span span;
+    span.text[0]  = '\0';
+    span.length   = 0;
+    span.position = position;
+    span.size     = size;
+    span.spacing  = spacing;
+
+    m_spans.push_back(span);
+
+    // Reserve for every span at its longest so rebuilds never reallocate
+    m_vertices.reserve(m_spans.size() * MAX_SPAN_LENGTH * VERTICES_PER_GLYPH * FLOATS_PER_VERTEX);
+
+    return (int) m_spans.size() - 1;
+}
+
+void TextBatch::set_text(int span, const char *text)
+{
+    Span &target = m_spans[span];
+
+    if (strncmp(target.text, text, MAX_SPAN_LENGTH) == 0) return;
+
+    strncpy(target.text, text, MAX_SPAN_LENGTH);
+    target.text[MAX_SPAN_LENGTH] = '\0';
+    target.length = (int) strlen(target.text);
+
+    m_is_dirty = true;
+}
+
+void TextBatch::set_position(int span, glm::vec3 position)
+{
+    if (m_spans[span].position == position) return;
+
+    m_spans[span].position = position;
+    m_is_dirty = true;
+}
+
+void TextBatch::rebuild()
+{
+    const float glyph_width = 1.0f / FONTBANK_SIZE;
+
+    m_vertices.clear();
+
+    for (const Span &span : m_spans)
+    {
+        float half_size = span.size / 2.0f;
+
+        for (int i = 0; i < span.length; i++)
+        {
+            // The atlas is 16 x 16, so the glyph's cell is a mask and a shift away
+            unsigned char glyph = (unsigned char) span.text[i];
+            float u = (float) (glyph & (FONTBANK_SIZE - 1)) * glyph_width;
+            float v = (float) (glyph >> 4) * glyph_width;
+
+            float x = span.position.x + (span.size + span.spacing) * i;
+            float y = span.position.y;
+
+            float quad[] =
+            {
+                x - half_size, y + half_size, u,               v,
+                x - half_size, y - half_size, u,               v + glyph_width,
+                x + half_size, y + half_size, u + glyph_width, v,
+                x + half_size, y - half_size, u + glyph_width, v + glyph_width,
+                x + half_size, y + half_size, u + glyph_width, v,
+                x - half_size, y - half_size, u,               v + glyph_width,
+            };
+
+            m_vertices.insert(m_vertices.end(), quad, quad + VERTICES_PER_GLYPH * FLOATS_PER_VERTEX);
+        }
+    }
+
+    m_vertex_count = (int) m_vertices.size() / FLOATS_PER_VERTEX;
+
+    if (m_vertex_buffer == 0) glGenBuffers(1, &m_vertex_buffer);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(float), m_vertices.data(), GL_DYNAMIC_DRAW);
+
+    m_is_dirty = false;
+    m_rebuilds++;
+}
+
+void TextBatch::render(ShaderProgram *program)
+{
+    if (m_is_dirty) rebuild();
+    else glBindBuffer(GL_ARRAY_BUFFER, m_vertex_buffer);
+
+    if (m_vertex_count > 0)
+    {
+        // Glyph positions are already in world space
+        program->SetModelMatrix(glm::mat4(1.0f));
+
+        glBindTexture(GL_TEXTURE_2D, m_font_texture_id);
+
+        GLsizei stride = FLOATS_PER_VERTEX * sizeof(float);
+        glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, stride, (void *) 0);
+        glEnableVertexAttribArray(program->positionAttribute);
+        glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, stride, (void *) (2 * sizeof(float)));
+        glEnableVertexAttribArray(program->texCoordAttribute);
+
+        draw_arrays(GL_TRIANGLES, 0, m_vertex_count);
+
+        glDisableVertexAttribArray(program->positionAttribute);
+        glDisableVertexAttribArray(program->texCoordAttribute);
+    }
+
+    // Everything else still draws from client-side arrays
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
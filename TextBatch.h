@@ -0,0 +1,62 @@
+#pragma once
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+#include <vector>
+#include "glm/mat4x4.hpp"
+#include "ShaderProgram.h"
+
+/**
+ * A group of strings drawn from a 16 x 16 glyph atlas (assets/font1.png) with
+ * a single draw call.
+ *
+ * Every span's glyph quads live in one vertex buffer. The buffer is only
+ * rebuilt and re-uploaded when set_text() is handed a string that differs from
+ * what the span already shows, so a HUD whose numbers have not moved costs one
+ * bind and one glDrawArrays per frame.
+ */
+class TextBatch
+{
+public:
+    // ––––– STATIC ATTRIBUTES ––––– //
+    // Ahead of Span, whose text buffer is sized from MAX_SPAN_LENGTH
+    static const int FONTBANK_SIZE   = 16;
+    static const int MAX_SPAN_LENGTH = 63;
+
+private:
+    struct Span
+    {
+        char text[MAX_SPAN_LENGTH + 1];
+        int length;
+        glm::vec3 position; // centre of the first glyph
+        float size;
+        float spacing;
+    };
+
+    GLuint m_font_texture_id;
+    GLuint m_vertex_buffer = 0;
+    std::vector<Span> m_spans;
+    std::vector<float> m_vertices; // interleaved x, y, u, v
+    int m_vertex_count = 0;
+    bool m_is_dirty    = true;
+    int m_rebuilds     = 0;
+
+    void rebuild();
+
+public:
+    // ––––– METHODS ––––– //
+    TextBatch(GLuint font_texture_id);
+    ~TextBatch();
+
+    int  add_span(glm::vec3 position, float size, float spacing);
+    void set_text(int span, const char *text);
+    void set_position(int span, glm::vec3 position);
+    void render(ShaderProgram *program);
+
+    // ––––– GETTERS ––––– //
+    bool const is_dirty()     const { return m_is_dirty; };
+    int  const get_rebuilds() const { return m_rebuilds; };
+};
@@ -0,0 +1,179 @@
+#define GL_SILENCE_DEPRECATION
+
+#include <algorithm>
+#include <cstring>
+#include "stb_image.h"
+#include "Texture.h"
+#include "TextureCompression.h"
+
+const int NUMBER_OF_TEXTURES = 1;
+const GLint TEXTURE_BORDER   = 0;
+
+static void set_texture_parameters(const TextureImage &image, const TextureOptions &options)
+{
+    GLint min_filter, mag_filter;
+
+    if (options.filter == FILTER_LINEAR)
+    {
+        mag_filter = GL_LINEAR;
+        min_filter = image.level_count > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+    }
+    else
+    {
+        mag_filter = GL_NEAREST;
+        min_filter = image.level_count > 1 ? GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST;
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.level_count - 1);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+}
+
+// ––––– COMPRESSED TEXTURES ––––– //
+bool detect_compressed_texture_support()
+{
+    GLint format_count = 0;
+    glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &format_count);
+
+    std::vector<GLint> formats(std::max(0, format_count));
+    if (format_count > 0) glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+
+    if (std::find(formats.begin(), formats.end(), (GLint) GL_COMPRESSED_RGBA_BPTC_UNORM) != formats.end()) return true;
+
+    // Some drivers leave BPTC out of that list but still advertise the extension
+    const char *extensions = (const char *) glGetString(GL_EXTENSIONS);
+    return extensions != NULL && strstr(extensions, "GL_ARB_texture_compression_bptc") != NULL;
+}
+
+static void upload_level(const TextureImage &image, int level, bool same_size)
+{
+    const unsigned char *pixels = &image.pixels[image.level_offset[level]];
+    GLsizei width  = image.level_width[level];
+    GLsizei height = image.level_height[level];
+
+    if (image.compressed_format != 0)
+    {
+        GLsizei size = (GLsizei) compressed_level_size(width, height);
+
+        if (same_size)
+        {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, image.compressed_format,
+                                      size, pixels);
+        }
+        else
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, image.compressed_format, width, height,
+                                   TEXTURE_BORDER, size, pixels);
+        }
+    }
+    else if (same_size)
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
+    else
+    {
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, width, height, TEXTURE_BORDER, GL_RGBA, GL_UNSIGNED_BYTE,
+                     pixels);
+    }
+}
+
+GLuint create_texture(const TextureImage &image, const TextureOptions &options)
+{
+    GLuint texture_id;
+    glGenTextures(NUMBER_OF_TEXTURES, &texture_id);
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+
+    // Every level comes from the CPU-built chain, so there is no glGenerateMipmap stall
+    for (int level = 0; level < image.level_count; level++) upload_level(image, level, false);
+
+    set_texture_parameters(image, options);
+
+    return texture_id;
+}
+
+void replace_texture(GLuint texture_id, const TextureImage &image, bool same_size)
+{
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+
+    for (int level = 0; level < image.level_count; level++) upload_level(image, level, same_size);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.level_count - 1);
+}
+
+// ––––– DIRECT UPLOAD ––––– //
+struct PixelBuffer
+{
+    GLuint buffer;
+    unsigned char *pixels;
+    int number_of_components;
+};
+
+// Upload formats by channel count; the texture itself is always RGBA so a hot
+// reload can write RGBA8 levels over it
+static const GLenum PIXEL_FORMATS[] = { 0, GL_LUMINANCE, GL_LUMINANCE_ALPHA, GL_RGB, GL_RGBA };
+
+// Called by the decoder once it knows the size: the PNG is unfiltered (or its
+// palette expanded) straight into this mapping
+static stbi_uc *map_pixel_buffer(void *user, int width, int height, int number_of_components)
+{
+    PixelBuffer *target = (PixelBuffer *) user;
+
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr) width * height * number_of_components, NULL, GL_STREAM_DRAW);
+    target->pixels = (unsigned char *) glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    target->number_of_components = number_of_components;
+
+    return target->pixels;
+}
+
+GLuint create_texture_direct(const char *filepath, const TextureOptions &options, TextureImage &info)
+{
+    if (!can_upload_directly(filepath, options)) return 0;
+
+    PixelBuffer target = { 0, NULL, 0 };
+    glGenBuffers(1, &target.buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, target.buffer);
+
+    int width, height, number_of_components;
+    unsigned char *decoded = stbi_load_png_into(filepath, &width, &height, &number_of_components, 0,
+                                                map_pixel_buffer, &target);
+
+    // The contents of a mapping can be lost (e.g. on a mode switch); then fall back
+    bool is_intact = target.pixels != NULL && glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+
+    // 16-bit, interlaced and colour-keyed PNGs come back in malloc'd memory
+    // instead; those take the normal path rather than a second upload path here
+    if (decoded != NULL && decoded != target.pixels) stbi_image_free(decoded);
+
+    GLuint texture_id = 0;
+    if (decoded != NULL && decoded == target.pixels && is_intact)
+    {
+        glGenTextures(NUMBER_OF_TEXTURES, &texture_id);
+        glBindTexture(GL_TEXTURE_2D, texture_id);
+
+        // RGB and grey rows are not 4-byte aligned
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, TEXTURE_BORDER,
+                     PIXEL_FORMATS[target.number_of_components], GL_UNSIGNED_BYTE, (const void *) 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        info.width             = width;
+        info.height            = height;
+        info.level_count       = 1;
+        info.compressed_format = 0;
+        info.level_width[0]    = width;
+        info.level_height[0]   = height;
+        info.level_offset[0]   = 0;
+        info.pixels.clear();
+
+        set_texture_parameters(info, options);
+    }
+
+    // The driver keeps the buffer alive until the copy out of it is done
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &target.buffer);
+
+    return texture_id;
+}
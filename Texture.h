@@ -0,0 +1,75 @@
+#pragma once
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Not every GL header ships the BPTC enums
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+enum TextureFilter { FILTER_NEAREST, FILTER_LINEAR };
+
+struct TextureOptions
+{
+    TextureFilter filter = FILTER_NEAREST;
+    bool mipmaps         = false;
+
+    // Largest size the texture is ever drawn at, in pixels. Bigger sources are
+    // box-filtered down to it before upload; 0 keeps the source size.
+    int display_width  = 0;
+    int display_height = 0;
+};
+
+/**
+ * A texture with its whole mip chain, ready to upload. Levels are stored back
+ * to back in `pixels`, largest first, as RGBA8 or — when compressed_format is
+ * set — as that format's blocks.
+ */
+struct TextureImage
+{
+    static const int MAX_LEVELS = 16;
+
+    int width  = 0;
+    int height = 0;
+    int level_count = 0;
+    GLenum compressed_format = 0;
+    int level_width[MAX_LEVELS];
+    int level_height[MAX_LEVELS];
+    size_t level_offset[MAX_LEVELS];
+    std::vector<unsigned char> pixels;
+};
+
+// ––––– TEXTURE CACHE ––––– //
+// Built images (downscaled, with mips) are written here and reused while the
+// source file is unchanged. Leave unset to always build from the PNG.
+void set_texture_cache_directory(const std::string &directory);
+const std::string &get_texture_cache_directory();
+
+uint64_t hash_texture_options(const TextureOptions &options);
+
+// ––––– COMPRESSED TEXTURES ––––– //
+// Once enabled, a PNG with an up-to-date .bc7 file next to it is loaded from
+// that file instead: uploaded as blocks when the driver takes BPTC, decoded
+// to RGBA8 on the CPU when it does not.
+bool detect_compressed_texture_support();
+void use_compressed_textures(bool upload_blocks);
+
+// ––––– BUILDING AND UPLOADING ––––– //
+bool build_texture_image(const char *filepath, const TextureOptions &options, TextureImage &image);
+GLuint create_texture(const TextureImage &image, const TextureOptions &options);
+void replace_texture(GLuint texture_id, const TextureImage &image, bool same_size);
+
+// A texture with no mips, no downscale and no .bc7 file has nothing to build,
+// so it can be decoded straight into a mapped pixel buffer and uploaded from
+// there in the PNG's own channels. create_texture_direct() returns 0 (and
+// uploads nothing) whenever the texture has to go through build_texture_image
+// instead; `info` gets the size for the asset watcher.
+bool can_upload_directly(const char *filepath, const TextureOptions &options);
+GLuint create_texture_direct(const char *filepath, const TextureOptions &options, TextureImage &info);
@@ -0,0 +1,655 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "Hash.h"
+#include "Texture.h"
+#include "TextureCompression.h"
+
+// ––––– BIT PACKING ––––– //
+// BC7 blocks are one 128-bit little-endian field, filled from bit 0 upwards
+struct BlockWriter
+{
+    unsigned char *block;
+    int position = 0;
+
+    void put(unsigned value, int bits)
+    {
+        for (int i = 0; i < bits; i++, position++)
+        {
+            if (value & (1u << i)) block[position >> 3] |= (unsigned char) (1u << (position & 7));
+        }
+    }
+};
+
+struct BlockReader
+{
+    const unsigned char *block;
+    int position = 0;
+
+    unsigned get(int bits)
+    {
+        unsigned value = 0;
+        for (int i = 0; i < bits; i++, position++)
+        {
+            value |= (unsigned) ((block[position >> 3] >> (position & 7)) & 1) << i;
+        }
+        return value;
+    }
+};
+
+static const int WEIGHTS_2[4]  = { 0, 21, 43, 64 };
+static const int WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+static int interpolate(int e0, int e1, int weight)
+{
+    return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+}
+
+// ––––– ENCODING ––––– //
+// Both modes fit a line segment through some of the block's channels: pick
+// the endpoints, snap every pixel to the nearest of the segment's palette
+// entries, then refit the endpoints to those choices by least squares.
+struct BlockPixels
+{
+    float values[16][4];
+};
+
+// Principal axis of channels [first, first + count) by power iteration on the covariance
+static void fit_line(const BlockPixels &pixels, int first, int count, float endpoints[2][4])
+{
+    float mean[4] = {};
+    for (int i = 0; i < 16; i++)
+    {
+        for (int c = first; c < first + count; c++) mean[c] += pixels.values[i][c] / 16.0f;
+    }
+
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; i++)
+    {
+        for (int a = first; a < first + count; a++)
+        {
+            for (int b = first; b < first + count; b++)
+            {
+                covariance[a][b] += (pixels.values[i][a] - mean[a]) * (pixels.values[i][b] - mean[b]);
+            }
+        }
+    }
+
+    float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+        float next[4] = {};
+        float length  = 0.0f;
+        for (int a = first; a < first + count; a++)
+        {
+            for (int b = first; b < first + count; b++) next[a] += covariance[a][b] * axis[b];
+            length += next[a] * next[a];
+        }
+
+        if (length < 1e-6f) break;   // flat block; the axis does not matter
+
+        length = std::sqrt(length);
+        for (int a = first; a < first + count; a++) axis[a] = next[a] / length;
+    }
+
+    float low = 0.0f, high = 0.0f;
+    for (int i = 0; i < 16; i++)
+    {
+        float t = 0.0f;
+        for (int c = first; c < first + count; c++) t += (pixels.values[i][c] - mean[c]) * axis[c];
+        low  = std::min(low, t);
+        high = std::max(high, t);
+    }
+
+    for (int c = first; c < first + count; c++)
+    {
+        endpoints[0][c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * low));
+        endpoints[1][c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * high));
+    }
+}
+
+// Nearest palette entry for each pixel; returns the summed squared error
+static int choose_indices(const BlockPixels &pixels, int first, int count, const int endpoints[2][4],
+                          const int *weights, int weight_count, int indices[16])
+{
+    int palette[16][4];
+    for (int index = 0; index < weight_count; index++)
+    {
+        for (int c = first; c < first + count; c++)
+        {
+            palette[index][c] = interpolate(endpoints[0][c], endpoints[1][c], weights[index]);
+        }
+    }
+
+    int error = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        int closest = -1;
+        for (int index = 0; index < weight_count; index++)
+        {
+            int distance = 0;
+            for (int c = first; c < first + count; c++)
+            {
+                int difference = palette[index][c] - (int) pixels.values[i][c];
+                distance += difference * difference;
+            }
+            if (closest < 0 || distance < closest)
+            {
+                closest    = distance;
+                indices[i] = index;
+            }
+        }
+        error += closest;
+    }
+    return error;
+}
+
+// Least-squares endpoints for fixed indices; leaves them alone if every pixel
+// picked the same weight
+static void refit_line(const BlockPixels &pixels, int first, int count, const int *weights,
+                       const int indices[16], float endpoints[2][4])
+{
+    float a = 0.0f, b = 0.0f, c = 0.0f;
+    float d0[4] = {}, d1[4] = {};
+
+    for (int i = 0; i < 16; i++)
+    {
+        float w = weights[indices[i]] / 64.0f;
+        a += (1.0f - w) * (1.0f - w);
+        b += (1.0f - w) * w;
+        c += w * w;
+        for (int channel = first; channel < first + count; channel++)
+        {
+            d0[channel] += (1.0f - w) * pixels.values[i][channel];
+            d1[channel] += w * pixels.values[i][channel];
+        }
+    }
+
+    float determinant = a * c - b * b;
+    if (std::fabs(determinant) < 1e-6f) return;
+
+    for (int channel = first; channel < first + count; channel++)
+    {
+        float e0 = (c * d0[channel] - b * d1[channel]) / determinant;
+        float e1 = (a * d1[channel] - b * d0[channel]) / determinant;
+        endpoints[0][channel] = std::min(255.0f, std::max(0.0f, e0));
+        endpoints[1][channel] = std::min(255.0f, std::max(0.0f, e1));
+    }
+}
+
+// The first pixel's index is stored with its top bit dropped, so it must be
+// in the lower half; swapping the endpoints mirrors every index to get there
+static void fix_anchor(int first, int count, int weight_count, int endpoints[2][4], int indices[16])
+{
+    if (indices[0] < weight_count / 2) return;
+
+    for (int c = first; c < first + count; c++) std::swap(endpoints[0][c], endpoints[1][c]);
+    for (int i = 0; i < 16; i++) indices[i] = weight_count - 1 - indices[i];
+}
+
+// Mode 6: one RGBA line, 7-bit endpoints plus a low bit per endpoint, 4-bit indices
+static int encode_mode_6(const BlockPixels &pixels, unsigned char *block)
+{
+    float line[2][4];
+    fit_line(pixels, 0, 4, line);
+
+    int best_error = -1;
+    int best_quantised[2][4], best_p[2], best_indices[16];
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        int pass_indices[16];
+        int pass_error = -1;
+
+        for (int p0 = 0; p0 < 2; p0++)
+        {
+            for (int p1 = 0; p1 < 2; p1++)
+            {
+                int p[2] = { p0, p1 };
+                int quantised[2][4], endpoints[2][4], indices[16];
+
+                for (int e = 0; e < 2; e++)
+                {
+                    for (int c = 0; c < 4; c++)
+                    {
+                        quantised[e][c] = std::min(127, std::max(0, (int) std::lround((line[e][c] - p[e]) / 2.0f)));
+                        endpoints[e][c] = (quantised[e][c] << 1) | p[e];
+                    }
+                }
+
+                int error = choose_indices(pixels, 0, 4, endpoints, WEIGHTS_4, 16, indices);
+                if (pass_error < 0 || error < pass_error)
+                {
+                    pass_error = error;
+                    memcpy(pass_indices, indices, sizeof(indices));
+                }
+                if (best_error < 0 || error < best_error)
+                {
+                    best_error = error;
+                    memcpy(best_quantised, quantised, sizeof(quantised));
+                    memcpy(best_p, p, sizeof(p));
+                    memcpy(best_indices, indices, sizeof(indices));
+                }
+            }
+        }
+
+        refit_line(pixels, 0, 4, WEIGHTS_4, pass_indices, line);
+    }
+
+    if (best_indices[0] >= 8) std::swap(best_p[0], best_p[1]);
+    fix_anchor(0, 4, 16, best_quantised, best_indices);
+
+    memset(block, 0, BC7_BLOCK_BYTES);
+    BlockWriter writer = { block };
+
+    writer.put(1 << 6, 7);
+    for (int c = 0; c < 4; c++)
+    {
+        writer.put(best_quantised[0][c], 7);
+        writer.put(best_quantised[1][c], 7);
+    }
+    writer.put(best_p[0], 1);
+    writer.put(best_p[1], 1);
+
+    writer.put(best_indices[0], 3);
+    for (int i = 1; i < 16; i++) writer.put(best_indices[i], 4);
+
+    return best_error;
+}
+
+// Mode 5: an RGB line and a separate alpha line, 2-bit indices each. The
+// rotation swaps alpha with one colour channel first, so whichever channel
+// varies independently of the others gets the line to itself.
+static int expand_7_bits(int value) { return (value << 1) | (value >> 6); }
+
+static int encode_mode_5(const BlockPixels &source, int rotation, unsigned char *block)
+{
+    BlockPixels pixels = source;
+    if (rotation != 0)
+    {
+        for (int i = 0; i < 16; i++) std::swap(pixels.values[i][rotation - 1], pixels.values[i][3]);
+    }
+
+    int colour[2][4], alpha[2][4];
+    int colour_indices[16], alpha_indices[16];
+    int colour_error = 0, alpha_error = 0;
+
+    float line[2][4];
+    fit_line(pixels, 0, 3, line);
+    fit_line(pixels, 3, 1, line);
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        int endpoints[2][4];
+        for (int e = 0; e < 2; e++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                colour[e][c]    = std::min(127, std::max(0, (int) std::lround(line[e][c] * 127.0f / 255.0f)));
+                endpoints[e][c] = expand_7_bits(colour[e][c]);
+            }
+            alpha[e][3]     = (int) std::lround(line[e][3]);
+            endpoints[e][3] = alpha[e][3];
+        }
+
+        colour_error = choose_indices(pixels, 0, 3, endpoints, WEIGHTS_2, 4, colour_indices);
+        alpha_error  = choose_indices(pixels, 3, 1, endpoints, WEIGHTS_2, 4, alpha_indices);
+
+        if (pass == 0)
+        {
+            refit_line(pixels, 0, 3, WEIGHTS_2, colour_indices, line);
+            refit_line(pixels, 3, 1, WEIGHTS_2, alpha_indices, line);
+        }
+    }
+
+    fix_anchor(0, 3, 4, colour, colour_indices);
+    fix_anchor(3, 1, 4, alpha, alpha_indices);
+
+    memset(block, 0, BC7_BLOCK_BYTES);
+    BlockWriter writer = { block };
+
+    writer.put(1 << 5, 6);
+    writer.put(rotation, 2);
+    for (int c = 0; c < 3; c++)
+    {
+        writer.put(colour[0][c], 7);
+        writer.put(colour[1][c], 7);
+    }
+    writer.put(alpha[0][3], 8);
+    writer.put(alpha[1][3], 8);
+
+    writer.put(colour_indices[0], 1);
+    for (int i = 1; i < 16; i++) writer.put(colour_indices[i], 2);
+    writer.put(alpha_indices[0], 1);
+    for (int i = 1; i < 16; i++) writer.put(alpha_indices[i], 2);
+
+    return colour_error + alpha_error;
+}
+
+void bc7_encode_block(const unsigned char *rgba, unsigned char *block)
+{
+    BlockPixels pixels;
+    for (int i = 0; i < 16; i++)
+    {
+        for (int c = 0; c < 4; c++) pixels.values[i][c] = rgba[i * 4 + c];
+    }
+
+    int best_error = encode_mode_6(pixels, block);
+
+    for (int rotation = 0; rotation < 4 && best_error > 0; rotation++)
+    {
+        unsigned char candidate[BC7_BLOCK_BYTES];
+        int error = encode_mode_5(pixels, rotation, candidate);
+        if (error < best_error)
+        {
+            best_error = error;
+            memcpy(block, candidate, BC7_BLOCK_BYTES);
+        }
+    }
+}
+
+// ––––– DECODING ––––– //
+// Only the two modes the encoder writes are understood
+bool bc7_decode_block(const unsigned char *block, unsigned char *rgba)
+{
+    BlockReader reader = { block };
+
+    // The mode is the number of zero bits before the first one
+    int mode = 0;
+    while (mode < 8 && !(block[0] & (1 << mode))) mode++;
+
+    if (mode == 6)
+    {
+        reader.get(7);
+
+        int endpoints[2][4];
+        for (int c = 0; c < 4; c++)
+        {
+            endpoints[0][c] = reader.get(7) << 1;
+            endpoints[1][c] = reader.get(7) << 1;
+        }
+
+        int p0 = reader.get(1);
+        int p1 = reader.get(1);
+        for (int c = 0; c < 4; c++)
+        {
+            endpoints[0][c] |= p0;
+            endpoints[1][c] |= p1;
+        }
+
+        for (int i = 0; i < 16; i++)
+        {
+            int weight = WEIGHTS_4[reader.get(i == 0 ? 3 : 4)];
+            for (int c = 0; c < 4; c++)
+            {
+                rgba[i * 4 + c] = (unsigned char) interpolate(endpoints[0][c], endpoints[1][c], weight);
+            }
+        }
+        return true;
+    }
+
+    if (mode != 5) return false;
+
+    reader.get(6);
+    int rotation = reader.get(2);
+
+    int endpoints[2][4];
+    for (int c = 0; c < 3; c++)
+    {
+        endpoints[0][c] = expand_7_bits(reader.get(7));
+        endpoints[1][c] = expand_7_bits(reader.get(7));
+    }
+    endpoints[0][3] = reader.get(8);
+    endpoints[1][3] = reader.get(8);
+
+    for (int i = 0; i < 16; i++)
+    {
+        int weight = WEIGHTS_2[reader.get(i == 0 ? 1 : 2)];
+        for (int c = 0; c < 3; c++)
+        {
+            rgba[i * 4 + c] = (unsigned char) interpolate(endpoints[0][c], endpoints[1][c], weight);
+        }
+    }
+    for (int i = 0; i < 16; i++)
+    {
+        int weight = WEIGHTS_2[reader.get(i == 0 ? 1 : 2)];
+        rgba[i * 4 + 3] = (unsigned char) interpolate(endpoints[0][3], endpoints[1][3], weight);
+    }
+
+    if (rotation != 0)
+    {
+        for (int i = 0; i < 16; i++) std::swap(rgba[i * 4 + rotation - 1], rgba[i * 4 + 3]);
+    }
+    return true;
+}
+
+// ––––– WHOLE IMAGES ––––– //
+size_t compressed_level_size(int width, int height)
+{
+    return (size_t) ((width + 3) / 4) * ((height + 3) / 4) * BC7_BLOCK_BYTES;
+}
+
+bool compress_texture_image(const TextureImage &source, TextureImage &compressed)
+{
+    if (source.compressed_format != 0) return false;
+
+    compressed = TextureImage();
+    compressed.width             = source.width;
+    compressed.height            = source.height;
+    compressed.level_count       = source.level_count;
+    compressed.compressed_format = GL_COMPRESSED_RGBA_BPTC_UNORM;
+
+    for (int level = 0; level < source.level_count; level++)
+    {
+        int width  = source.level_width[level];
+        int height = source.level_height[level];
+        const unsigned char *pixels = &source.pixels[source.level_offset[level]];
+
+        compressed.level_width[level]  = width;
+        compressed.level_height[level] = height;
+        compressed.level_offset[level] = compressed.pixels.size();
+        compressed.pixels.resize(compressed.pixels.size() + compressed_level_size(width, height));
+
+        unsigned char *block = &compressed.pixels[compressed.level_offset[level]];
+
+        for (int block_y = 0; block_y < height; block_y += 4)
+        {
+            for (int block_x = 0; block_x < width; block_x += 4, block += BC7_BLOCK_BYTES)
+            {
+                // Blocks hanging off the edge repeat the last row / column
+                unsigned char texels[16 * 4];
+                for (int y = 0; y < 4; y++)
+                {
+                    for (int x = 0; x < 4; x++)
+                    {
+                        int source_x = std::min(block_x + x, width - 1);
+                        int source_y = std::min(block_y + y, height - 1);
+                        memcpy(&texels[(y * 4 + x) * 4], &pixels[((size_t) source_y * width + source_x) * 4], 4);
+                    }
+                }
+
+                bc7_encode_block(texels, block);
+            }
+        }
+    }
+
+    return true;
+}
+
+bool decompress_texture_image(const TextureImage &compressed, TextureImage &decoded)
+{
+    if (compressed.compressed_format != GL_COMPRESSED_RGBA_BPTC_UNORM) return false;
+
+    decoded = TextureImage();
+    decoded.width       = compressed.width;
+    decoded.height      = compressed.height;
+    decoded.level_count = compressed.level_count;
+
+    for (int level = 0; level < compressed.level_count; level++)
+    {
+        int width  = compressed.level_width[level];
+        int height = compressed.level_height[level];
+        const unsigned char *block = &compressed.pixels[compressed.level_offset[level]];
+
+        decoded.level_width[level]  = width;
+        decoded.level_height[level] = height;
+        decoded.level_offset[level] = decoded.pixels.size();
+        decoded.pixels.resize(decoded.pixels.size() + (size_t) width * height * 4);
+
+        unsigned char *pixels = &decoded.pixels[decoded.level_offset[level]];
+
+        for (int block_y = 0; block_y < height; block_y += 4)
+        {
+            for (int block_x = 0; block_x < width; block_x += 4, block += BC7_BLOCK_BYTES)
+            {
+                unsigned char texels[16 * 4];
+                if (!bc7_decode_block(block, texels)) return false;
+
+                for (int y = 0; y < 4 && block_y + y < height; y++)
+                {
+                    for (int x = 0; x < 4 && block_x + x < width; x++)
+                    {
+                        memcpy(&pixels[((size_t) (block_y + y) * width + block_x + x) * 4],
+                               &texels[(y * 4 + x) * 4], 4);
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// ––––– .BC7 FILES ––––– //
+struct CompressedTextureHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t source_hash;
+    uint64_t options_hash;
+    int32_t width;
+    int32_t height;
+    int32_t level_count;
+    int32_t reserved;
+};
+
+static const char COMPRESSED_TEXTURE_MAGIC[4]    = { 'L', 'L', 'B', 'C' };
+static const uint32_t COMPRESSED_TEXTURE_VERSION = 1;
+
+std::string compressed_texture_path(const char *filepath)
+{
+    std::string path = filepath;
+    size_t extension = path.find_last_of('.');
+    if (extension != std::string::npos && path.find('/', extension) == std::string::npos) path.erase(extension);
+    return path + ".bc7";
+}
+
+bool hash_file(const char *filepath, uint64_t &hash)
+{
+    std::ifstream infile(filepath, std::ios::binary);
+    if (infile.fail()) return false;
+
+    std::string contents((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+    hash = hash_bytes(contents.data(), contents.size());
+    return true;
+}
+
+bool replace_file(const std::string &filepath, const void *header, size_t header_size, const void *body,
+                  size_t body_size)
+{
+    std::string temporary_path = filepath + ".tmp";
+
+    std::ofstream outfile(temporary_path, std::ios::binary | std::ios::trunc);
+    outfile.write((const char *) header, header_size);
+    outfile.write((const char *) body, body_size);
+    outfile.close();
+
+    // Windows will not rename over an existing file
+    bool is_written = !outfile.fail();
+    if (is_written && rename(temporary_path.c_str(), filepath.c_str()) != 0)
+    {
+        remove(filepath.c_str());
+        is_written = rename(temporary_path.c_str(), filepath.c_str()) == 0;
+    }
+
+    if (!is_written) remove(temporary_path.c_str());
+    return is_written;
+}
+
+bool write_compressed_texture(const char *filepath, const TextureImage &image, uint64_t source_hash,
+                              uint64_t options_hash)
+{
+    if (image.compressed_format != GL_COMPRESSED_RGBA_BPTC_UNORM) return false;
+
+    CompressedTextureHeader header;
+    memcpy(header.magic, COMPRESSED_TEXTURE_MAGIC, sizeof(header.magic));
+    header.version      = COMPRESSED_TEXTURE_VERSION;
+    header.source_hash  = source_hash;
+    header.options_hash = options_hash;
+    header.width        = image.width;
+    header.height       = image.height;
+    header.level_count  = image.level_count;
+    header.reserved     = 0;
+
+    std::ofstream outfile(filepath, std::ios::binary | std::ios::trunc);
+    outfile.write((const char *) &header, sizeof(header));
+    outfile.write((const char *) image.pixels.data(), image.pixels.size());
+    return outfile.good();
+}
+
+bool read_compressed_texture(const char *filepath, uint64_t source_hash, uint64_t options_hash,
+                             TextureImage &image)
+{
+    std::ifstream infile(filepath, std::ios::binary);
+    if (infile.fail()) return false;
+
+    CompressedTextureHeader header;
+    if (!infile.read((char *) &header, sizeof(header))) return false;
+
+    if (memcmp(header.magic, COMPRESSED_TEXTURE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != COMPRESSED_TEXTURE_VERSION ||
+        header.source_hash != source_hash ||
+        header.options_hash != options_hash ||
+        header.width <= 0 || header.height <= 0 ||
+        header.level_count <= 0 || header.level_count > TextureImage::MAX_LEVELS)
+    {
+        return false;
+    }
+
+    // The blocks are the rest of the file. Checking the top level first keeps
+    // a corrupt size from overflowing the sum below.
+    std::streampos start = infile.tellg();
+    infile.seekg(0, std::ios::end);
+    size_t remaining = (size_t) (infile.tellg() - start);
+    infile.seekg(start);
+    if (((size_t) header.width + 3) / 4 * (((size_t) header.height + 3) / 4) > remaining / BC7_BLOCK_BYTES)
+    {
+        return false;
+    }
+
+    image = TextureImage();
+    image.width             = header.width;
+    image.height            = header.height;
+    image.level_count       = header.level_count;
+    image.compressed_format = GL_COMPRESSED_RGBA_BPTC_UNORM;
+
+    size_t size = 0;
+    int width   = header.width;
+    int height  = header.height;
+    for (int level = 0; level < image.level_count; level++)
+    {
+        image.level_width[level]  = width;
+        image.level_height[level] = height;
+        image.level_offset[level] = size;
+        size  += compressed_level_size(width, height);
+        width  = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+
+    if (size > remaining) return false;
+
+    image.pixels.resize(size);
+    return (bool) infile.read((char *) image.pixels.data(), size);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+struct TextureImage;
+
+/**
+ * BC7 block compression for textures that are filtered and drawn scaled.
+ *
+ * Every 4 x 4 block is 16 bytes (8 bits per pixel against 32 for RGBA8). The
+ * encoder only tries the two single-line modes, picking per block:
+ *
+ *  - mode 6, one RGBA line with 4-bit indices, for smooth gradients;
+ *  - mode 5, separate RGB and alpha lines, for sprite edges where coverage
+ *    changes independently of colour.
+ *
+ * The decoder understands exactly those modes, which is all our files contain,
+ * so a driver without BPTC still gets correct pixels.
+ *
+ * Compressed textures are built offline by tools/asset_tool and stored next
+ * to their PNG as a .bc7 file:
+ *
+ *     header { "LLBC", version, source hash, options hash, width, height, level count }
+ *     blocks for level 0, level 1, ... back to back
+ */
+const int BC7_BLOCK_BYTES = 16;
+
+void bc7_encode_block(const unsigned char *rgba, unsigned char *block);
+bool bc7_decode_block(const unsigned char *block, unsigned char *rgba);
+
+size_t compressed_level_size(int width, int height);
+
+// RGBA image in, image of blocks out (with compressed_format set), and back
+bool compress_texture_image(const TextureImage &source, TextureImage &compressed);
+bool decompress_texture_image(const TextureImage &compressed, TextureImage &decoded);
+
+// ––––– .BC7 FILES ––––– //
+std::string compressed_texture_path(const char *filepath);
+bool hash_file(const char *filepath, uint64_t &hash);
+
+// Writes `header` and then `body` to a temporary file beside `filepath` and
+// renames it over `filepath`, so a crash or a second instance writing the
+// same file never leaves a torn one under the real name
+bool replace_file(const std::string &filepath, const void *header, size_t header_size, const void *body,
+                  size_t body_size);
+
+bool write_compressed_texture(const char *filepath, const TextureImage &image, uint64_t source_hash,
+                              uint64_t options_hash);
+bool read_compressed_texture(const char *filepath, uint64_t source_hash, uint64_t options_hash,
+                             TextureImage &image);
@@ -0,0 +1,340 @@
+#include <sys/stat.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "stb_image.h"
+#include "Hash.h"
+#include "Texture.h"
+#include "TextureCompression.h"
+
+#define LOG(argument) std::cout << argument << '\n'
+
+static std::string g_texture_cache_directory;
+static bool g_use_compressed_textures = false;
+static bool g_upload_compressed_blocks = false;
+
+// ––––– CACHE FILES ––––– //
+struct TextureCacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t source_size;
+    uint64_t source_hash;
+    uint64_t options_hash;
+    int32_t width;
+    int32_t height;
+    int32_t level_count;
+    int32_t reserved;
+};
+
+static const char TEXTURE_CACHE_MAGIC[4]     = { 'L', 'L', 'T', 'X' };
+static const uint32_t TEXTURE_CACHE_VERSION  = 2;
+
+// Only what changes the pixels goes into the key; the filter is a GL setting
+uint64_t hash_texture_options(const TextureOptions &options)
+{
+    int32_t key[] = { options.mipmaps ? 1 : 0, options.display_width, options.display_height };
+    return hash_bytes(key, sizeof(key));
+}
+
+static std::string cache_path(const char *filepath, uint64_t options_hash)
+{
+    char name[48];
+    snprintf(name, sizeof(name), "texture_%016llx.cache",
+             (unsigned long long) hash_bytes(filepath, strlen(filepath), options_hash));
+    return g_texture_cache_directory + name;
+}
+
+void set_texture_cache_directory(const std::string &directory)
+{
+    g_texture_cache_directory = directory;
+}
+
+const std::string &get_texture_cache_directory()
+{
+    return g_texture_cache_directory;
+}
+
+// Keyed on the PNG's contents: a hot-reloaded edit can keep the size and
+// land within the same second as the last one
+static bool read_cached_image(const char *filepath, const struct stat &source, uint64_t source_hash,
+                              uint64_t options_hash, TextureImage &image)
+{
+    std::ifstream infile(cache_path(filepath, options_hash), std::ios::binary);
+    if (infile.fail()) return false;
+
+    TextureCacheHeader header;
+    if (!infile.read((char *) &header, sizeof(header))) return false;
+
+    if (memcmp(header.magic, TEXTURE_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != TEXTURE_CACHE_VERSION ||
+        header.source_size != (uint64_t) source.st_size ||
+        header.source_hash != source_hash ||
+        header.options_hash != options_hash ||
+        header.width <= 0 || header.height <= 0 ||
+        header.level_count <= 0 || header.level_count > TextureImage::MAX_LEVELS)
+    {
+        return false;
+    }
+
+    // The pixels are the rest of the file. Checking the top level first keeps
+    // a corrupt size from overflowing the sum below.
+    std::streampos start = infile.tellg();
+    infile.seekg(0, std::ios::end);
+    size_t remaining = (size_t) (infile.tellg() - start);
+    infile.seekg(start);
+    if ((size_t) header.width * header.height > remaining / 4) return false;
+
+    image.width       = header.width;
+    image.height      = header.height;
+    image.level_count = header.level_count;
+
+    size_t size = 0;
+    int width   = header.width;
+    int height  = header.height;
+    for (int level = 0; level < image.level_count; level++)
+    {
+        image.level_width[level]  = width;
+        image.level_height[level] = height;
+        image.level_offset[level] = size;
+        size  += (size_t) width * height * 4;
+        width  = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+
+    if (size > remaining) return false;
+
+    image.pixels.resize(size);
+    return (bool) infile.read((char *) image.pixels.data(), size);
+}
+
+static void write_cached_image(const char *filepath, const struct stat &source, uint64_t source_hash,
+                               uint64_t options_hash, const TextureImage &image)
+{
+    TextureCacheHeader header;
+    memcpy(header.magic, TEXTURE_CACHE_MAGIC, sizeof(header.magic));
+    header.version      = TEXTURE_CACHE_VERSION;
+    header.source_size  = (uint64_t) source.st_size;
+    header.source_hash  = source_hash;
+    header.options_hash = options_hash;
+    header.width        = image.width;
+    header.height       = image.height;
+    header.level_count  = image.level_count;
+    header.reserved     = 0;
+
+    replace_file(cache_path(filepath, options_hash), &header, sizeof(header), image.pixels.data(),
+                 image.pixels.size());
+}
+
+// ––––– COMPRESSED TEXTURES ––––– //
+void use_compressed_textures(bool upload_blocks)
+{
+    g_use_compressed_textures  = true;
+    g_upload_compressed_blocks = upload_blocks;
+}
+
+// Keyed on the PNG's contents rather than its mtime, which a checkout does not keep
+static bool read_compressed_image(const char *filepath, uint64_t source_hash, uint64_t options_hash,
+                                  TextureImage &image)
+{
+    std::string compressed_path = compressed_texture_path(filepath);
+
+    struct stat compressed_file;
+    if (stat(compressed_path.c_str(), &compressed_file) != 0) return false;
+
+    TextureImage compressed;
+    if (!read_compressed_texture(compressed_path.c_str(), source_hash, options_hash, compressed))
+    {
+        LOG("Ignoring out-of-date " << compressed_path << "; rebuild it with asset_tool.");
+        return false;
+    }
+
+    if (g_upload_compressed_blocks)
+    {
+        image = std::move(compressed);
+        return true;
+    }
+
+    return decompress_texture_image(compressed, image);
+}
+
+// ––––– FILTERING ––––– //
+// Filtering happens on premultiplied colour so fully transparent pixels do not
+// bleed their (usually black) RGB into the edges of a sprite.
+static std::vector<float> to_premultiplied(const unsigned char *pixels, int width, int height)
+{
+    std::vector<float> result((size_t) width * height * 4);
+
+    for (size_t i = 0; i < (size_t) width * height; i++)
+    {
+        float alpha = pixels[i * 4 + 3] / 255.0f;
+        result[i * 4 + 0] = pixels[i * 4 + 0] * alpha;
+        result[i * 4 + 1] = pixels[i * 4 + 1] * alpha;
+        result[i * 4 + 2] = pixels[i * 4 + 2] * alpha;
+        result[i * 4 + 3] = pixels[i * 4 + 3];
+    }
+
+    return result;
+}
+
+static void from_premultiplied(const std::vector<float> &source, unsigned char *pixels, int width, int height)
+{
+    for (size_t i = 0; i < (size_t) width * height; i++)
+    {
+        float alpha = source[i * 4 + 3];
+        float scale = alpha > 0.0f ? 255.0f / alpha : 0.0f;
+
+        for (int channel = 0; channel < 3; channel++)
+        {
+            float value = source[i * 4 + channel] * scale;
+            pixels[i * 4 + channel] = (unsigned char) std::min(255.0f, value + 0.5f);
+        }
+        pixels[i * 4 + 3] = (unsigned char) std::min(255.0f, alpha + 0.5f);
+    }
+}
+
+// Area-averaging (box) resample for any shrink factor, one axis at a time.
+// Each destination pixel is the coverage-weighted mean of the source pixels
+// its footprint overlaps.
+static std::vector<float> box_resample(const std::vector<float> &source, int source_width, int source_height,
+                                       int width, int height)
+{
+    std::vector<float> rows((size_t) width * source_height * 4, 0.0f);
+    float scale_x = (float) source_width / width;
+
+    for (int y = 0; y < source_height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            float start = x * scale_x;
+            float end   = start + scale_x;
+            float *out  = &rows[((size_t) y * width + x) * 4];
+
+            for (int source_x = (int) start; source_x < end && source_x < source_width; source_x++)
+            {
+                float coverage  = std::min(end, source_x + 1.0f) - std::max(start, (float) source_x);
+                const float *in = &source[((size_t) y * source_width + source_x) * 4];
+                for (int channel = 0; channel < 4; channel++) out[channel] += in[channel] * coverage;
+            }
+            for (int channel = 0; channel < 4; channel++) out[channel] /= scale_x;
+        }
+    }
+
+    std::vector<float> result((size_t) width * height * 4, 0.0f);
+    float scale_y = (float) source_height / height;
+
+    for (int y = 0; y < height; y++)
+    {
+        float start = y * scale_y;
+        float end   = start + scale_y;
+
+        for (int source_y = (int) start; source_y < end && source_y < source_height; source_y++)
+        {
+            float coverage  = (std::min(end, source_y + 1.0f) - std::max(start, (float) source_y)) / scale_y;
+            const float *in = &rows[(size_t) source_y * width * 4];
+            float *out      = &result[(size_t) y * width * 4];
+            for (int i = 0; i < width * 4; i++) out[i] += in[i] * coverage;
+        }
+    }
+
+    return result;
+}
+
+// ––––– BUILDING AND UPLOADING ––––– //
+bool can_upload_directly(const char *filepath, const TextureOptions &options)
+{
+    if (options.mipmaps) return false;
+
+    int width, height, number_of_components;
+    if (!stbi_info(filepath, &width, &height, &number_of_components)) return false;
+
+    if ((options.display_width  > 0 && width  > options.display_width) ||
+        (options.display_height > 0 && height > options.display_height))
+    {
+        return false;
+    }
+
+    struct stat compressed_file;
+    return !g_use_compressed_textures || stat(compressed_texture_path(filepath).c_str(), &compressed_file) != 0;
+}
+
+bool build_texture_image(const char *filepath, const TextureOptions &options, TextureImage &image)
+{
+    struct stat source;
+    if (stat(filepath, &source) != 0) return false;
+
+    uint64_t options_hash = hash_texture_options(options);
+    bool use_cache = !g_texture_cache_directory.empty();
+
+    // Both the .bc7 files and the cache are keyed on the PNG's contents
+    uint64_t source_hash = 0;
+    if ((g_use_compressed_textures || use_cache) && !hash_file(filepath, source_hash)) return false;
+
+    if (g_use_compressed_textures && read_compressed_image(filepath, source_hash, options_hash, image)) return true;
+    if (use_cache && read_cached_image(filepath, source, source_hash, options_hash, image)) return true;
+
+    int width, height, number_of_components;
+    unsigned char *decoded = stbi_load(filepath, &width, &height, &number_of_components, STBI_rgb_alpha);
+    if (decoded == NULL) return false;
+
+    // Never upscale; only shrink axes that are bigger than they are drawn
+    int target_width  = options.display_width  > 0 ? std::min(width,  options.display_width)  : width;
+    int target_height = options.display_height > 0 ? std::min(height, options.display_height) : height;
+
+    image.width       = target_width;
+    image.height      = target_height;
+    image.level_count = 1;
+
+    if (!options.mipmaps && target_width == width && target_height == height)
+    {
+        // Nothing to filter: keep the decoded pixels as they are
+        image.level_width[0]  = width;
+        image.level_height[0] = height;
+        image.level_offset[0] = 0;
+        image.pixels.assign(decoded, decoded + (size_t) width * height * 4);
+        stbi_image_free(decoded);
+
+        if (use_cache) write_cached_image(filepath, source, source_hash, options_hash, image);
+        return true;
+    }
+
+    std::vector<float> level = to_premultiplied(decoded, width, height);
+    stbi_image_free(decoded);
+
+    if (target_width != width || target_height != height)
+    {
+        level = box_resample(level, width, height, target_width, target_height);
+    }
+
+    width  = target_width;
+    height = target_height;
+
+    size_t size = 0;
+    for (int i = 0; i < TextureImage::MAX_LEVELS; i++)
+    {
+        image.level_width[i]  = width;
+        image.level_height[i] = height;
+        image.level_offset[i] = size;
+        image.level_count     = i + 1;
+
+        image.pixels.resize(size + (size_t) width * height * 4);
+        from_premultiplied(level, &image.pixels[size], width, height);
+        size = image.pixels.size();
+
+        if (!options.mipmaps || (width == 1 && height == 1)) break;
+
+        // Each mip level is a 2 x 2 box filter of the one above it
+        int next_width  = std::max(1, width / 2);
+        int next_height = std::max(1, height / 2);
+        level  = box_resample(level, width, height, next_width, next_height);
+        width  = next_width;
+        height = next_height;
+    }
+
+    if (use_cache) write_cached_image(filepath, source, source_hash, options_hash, image);
+    return true;
+}
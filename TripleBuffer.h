@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+
+/**
+ * Hands the latest value from one writer thread to one reader thread without
+ * either of them ever waiting on the other.
+ *
+ * There are three copies of T. The writer fills its back copy and publishes
+ * it by swapping it with the middle one; the reader swaps its front copy with
+ * the middle one when a fresh value is there. Both swaps are single atomic
+ * exchanges on the middle index, so a slow reader just skips values (counted
+ * in get_skipped()) and a slow writer leaves the reader drawing the last one.
+ */
+template <typename T>
+class TripleBuffer
+{
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH      = 4;   // set while the middle copy has not been read
+
+    T m_buffers[3];
+    std::atomic<int> m_middle { 1 };
+    int m_back  = 0;   // writer only
+    int m_front = 2;   // reader only
+
+    std::atomic<int> m_published { 0 };
+    std::atomic<int> m_skipped { 0 };
+
+public:
+    // ––––– WRITER ––––– //
+    T &get_back() { return m_buffers[m_back]; };
+
+    void publish()
+    {
+        int previous = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel);
+        m_back = previous & INDEX_MASK;
+
+        m_published.fetch_add(1, std::memory_order_relaxed);
+        if (previous & FRESH) m_skipped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // ––––– READER ––––– //
+    // Returns true when a newer value was picked up
+    bool acquire()
+    {
+        if ((m_middle.load(std::memory_order_relaxed) & FRESH) == 0) return false;
+
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T &get_front() const { return m_buffers[m_front]; };
+
+    // ––––– GETTERS ––––– //
+    int const get_published() const { return m_published.load(std::memory_order_relaxed); };
+    int const get_skipped()   const { return m_skipped.load(std::memory_order_relaxed);   };
+};
@@ -10,10 +10,12 @@
 
 #define GL_SILENCE_DEPRECATION
 #define STB_IMAGE_IMPLEMENTATION
+#define STBI_PNG_SIMD
 #define LOG(argument) std::cout << argument << '\n'
 #define GL_GLEXT_PROTOTYPES 1
 #define FIXED_TIMESTEP 0.0166666f
 #define PLATFORM_COUNT 5
+#define MAX_VISIBLE_PLATFORMS 64
 
 #ifdef _WINDOWS
 #include <GL/glew.h>
@@ -29,16 +31,129 @@
 #include <ctime>
 #include <vector>
 #include <cstdlib>
+#include <algorithm>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <random>
 #include <SDL_mixer.h>
+#include "Animation.h"
 #include "Entity.h"
+#include "FlowField.h"
+#include "TextBatch.h"
+#include "Hud.h"
+#include "Audio.h"
+#include "Arena.h"
+#include "Texture.h"
+#include "HotReload.h"
+#include "Input.h"
+#include "Capture.h"
+#include "GoldenImage.h"
+#include "RenderStats.h"
+#include "TripleBuffer.h"
+#include "FramePacer.h"
+#include "Camera.h"
+#include "Broadphase.h"
+#include "LevelStream.h"
+#include "Terrain.h"
+#include "CollisionMask.h"
+#include "Bridge.h"
+#include "Raycast.h"
+#include "Occupancy.h"
 
 // ––––– STRUCTS AND ENUMS ––––– //
 struct GameState
 {
-    Entity* player;
-    Entity* platforms;
-    Entity* messages;
-    Entity* background;
+    Entity* player      = NULL;
+    Entity* platforms   = NULL;
+    Entity* messages    = NULL;
+    Entity* background  = NULL;
+    FlowField* currents = NULL;
+    Terrain* terrain    = NULL;
+};
+
+// What render() draws, published by the simulation after every batch of
+// ticks. Nothing in it points at state the simulation goes on to change.
+struct RenderSnapshot
+{
+    glm::mat4 view_matrix;
+    glm::vec2 view_min, view_max;   // what the camera sees, for the terrain
+    
+    // World sprites, culled to the camera; the player is always drawn
+    SpriteSnapshot background;
+    SpriteSnapshot player;
+    SpriteSnapshot platforms[MAX_VISIBLE_PLATFORMS];
+    int platform_count;
+    
+    // Screen-space overlay
+    SpriteSnapshot messages[2];
+    
+    // HUD readouts
+    float fuel;
+    glm::vec3 velocity;
+    float altitude;
+    int score;
+    
+    int tick;
+    
+    // Compares the sprites only; the HUD tracks its own visible changes
+    bool const looks_like(const RenderSnapshot &other) const
+    {
+        if (view_matrix != other.view_matrix || platform_count != other.platform_count) return false;
+        if (!background.looks_like(other.background) || !player.looks_like(other.player)) return false;
+        
+        for (int i = 0; i < platform_count; i++) if (!platforms[i].looks_like(other.platforms[i])) return false;
+        for (int i = 0; i < 2; i++)              if (!messages[i].looks_like(other.messages[i]))   return false;
+        
+        return true;
+    };
+};
+
+// Per-iteration times of one thread's loop, in milliseconds
+struct LoopTimings
+{
+    int count        = 0;
+    double total     = 0.0;
+    double maximum   = 0.0;
+    
+    void add(double milliseconds)
+    {
+        count++;
+        total  += milliseconds;
+        maximum = std::max(maximum, milliseconds);
+    }
+    
+    double const get_mean() const { return count > 0 ? total / count : 0.0; };
+};
+
+struct LaunchOptions
+{
+    bool hot_reload              = false;
+    bool single_thread           = false;   // simulate and render in lockstep on the main thread
+    bool render_on_change        = true;    // skip frames that would look like the one on screen
+    int target_fps               = 60;      // 0 leaves the frame rate to vsync, or unlimited
+    VsyncMode vsync              = VSYNC_DEFAULT;
+    bool headless                = false;   // render into an offscreen framebuffer, no window
+    CaptureFormat capture_format = CAPTURE_NONE;
+    const char* capture_path     = NULL;
+    int frame_limit              = 0;       // quit after this many frames; 0 runs until closed
+    const char* level_filepath   = NULL;    // stream platforms from a level_tool level
+    const char* golden_directory = NULL;    // run the golden-image scenes instead of the game
+    const char* bridge_name      = NULL;    // serve a training client through this shared memory instead
+    int bridge_envs              = 64;
+    bool update_goldens          = false;
+    int golden_tolerance         = 2;       // per channel, out of 255
+};
+
+// A fixed game state for the golden-image run: the level as loaded, the
+// player moved to `start`, then `ticks` fixed steps with `movement` held
+struct GoldenScene
+{
+    const char* name;
+    glm::vec3 start;
+    glm::vec3 movement;
+    int facing;
+    int ticks;
 };
 
 // ––––– CONSTANTS ––––– //
@@ -55,109 +170,264 @@ const int VIEWPORT_X = 0,
           VIEWPORT_WIDTH  = WINDOW_WIDTH,
           VIEWPORT_HEIGHT = WINDOW_HEIGHT;
 
+const char PREF_ORGANISATION[] = "ctg",
+           PREF_APPLICATION[]  = "LunarLander";
+
 const char V_SHADER_PATH[] = "shaders/vertex_textured.glsl",
            F_SHADER_PATH[] = "shaders/fragment_textured.glsl";
 
 const float MILLISECONDS_IN_SECOND = 1000.0;
+
+// The view is a fixed 10 x 7.5 units around the camera. This level is one
+// screen, so the camera has nowhere to scroll; larger levels just widen the bounds.
+const glm::vec2 VIEW_HALF_SIZE     = glm::vec2(5.0f, 3.75f);
+const glm::vec2 LEVEL_MIN          = glm::vec2(-5.0f, -3.75f),
+                LEVEL_MAX          = glm::vec2(5.0f, 3.75f);
+const float     CAMERA_FOLLOW_RATE = 4.0f;
+
+const float BROADPHASE_CELL_SIZE  = 4.0f;
+const int   MAX_NEARBY_PLATFORMS  = 16;    // collision candidates per tick
+const float COLLISION_SWEEP_SLACK = 0.5f;  // covers the speed the player can gain within one tick
 const char BACKGROUND_FILEPATH[]      = "assets/background.png";
 const char SPRITESHEET_FILEPATH[]     = "assets/player_spritesheet.png";
+const char SPRITESHEET_ANIM_FILEPATH[] = "assets/player_spritesheet.anim";
 const char WIN_PLATFORM_FILEPATH[]    = "assets/treasure_chest.png";
 const char WIN_MESSAGE_FILEPATH[]     = "assets/win.png";
 const char LOSE_PLATFORM_FILEPATH[]   = "assets/jellyfish.png";
 const char LOSE_MESSAGE_FILEPATH[]    = "assets/lost.png";
+const char FONT_FILEPATH[]            = "assets/font1.png";
+const char MUSIC_FILEPATH[]           = "assets/audio/music.wav";
+const char *const SOUND_EFFECT_FILEPATHS[SFX_COUNT] =
+{
+    "assets/audio/thruster.wav",
+    "assets/audio/bubble.wav",
+    "assets/audio/win.wav",
+    "assets/audio/lose.wav",
+};
+
+const float FLOW_CELL_SIZE    = 0.5f;
+const int   FLOW_COLS         = 21,
+            FLOW_ROWS         = 16;
+const int   MAX_CURRENT_BODIES = 64;
+const int   MAX_EDDIES         = 8;
+
+const size_t LEVEL_ARENA_SIZE   = 768 * 1024;   // room for the streamed level's chunk slots and masks
+const int    MAX_LEVEL_TEXTURES = 16;
+
+const float PLAYER_FUEL           = 100.0f,
+            PLAYER_FUEL_BURN_RATE = 8.0f;
+const float SEABED_Y              = -3.75f;   // bottom of the terrain
+const float PLAYER_SPRITE_SIZE    = 1.0f;     // drawn unscaled, a unit square
+const int   SCORE_PER_LANDING     = 100,
+            SCORE_PER_FUEL        = 10;
+const glm::vec3 HUD_TOP_LEFT      = glm::vec3(-4.75f, 3.5f, 0.0f);
+
+const float    TERRAIN_SPACING   = 0.25f;
+const float    TERRAIN_BASE_Y    = -3.45f;     // the chests sit just clear of the highest dunes
+const float    TERRAIN_AMPLITUDE = 0.25f;
+const uint32_t TERRAIN_SEED      = 1969;
+
+// Training bridge: observations are position, velocity, fuel left (0 to 1),
+// altitude and a fan of range finders, with an occupancy grid as each
+// lander's image; actions are the thrust axis, each component -1 to 1
+const int   BRIDGE_SENSOR_RAYS      = 8;      // evenly spaced from +x, anticlockwise
+const float BRIDGE_SENSOR_RANGE     = 6.0f;
+const int   BRIDGE_OBSERVATION_SIZE = 6 + BRIDGE_SENSOR_RAYS,
+            BRIDGE_ACTION_SIZE      = 2;
+const int   BRIDGE_EPISODE_TICKS    = 60 * 60;   // a minute of game time, then the episode ends undecided
+const float BRIDGE_SPAWN_Y          = 3.0f,
+            BRIDGE_SPAWN_SPREAD     = 2.0f;      // spawn x is drawn from [-spread, spread]
+
+const glm::vec3 BACKGROUND_OFFSET = glm::vec3(0.0f, -1.5f, 0.0f),   // from the camera
+                BACKGROUND_SIZE   = glm::vec3(11.5f, 8.0f, 1.0f);
 
-const int NUMBER_OF_TEXTURES = 1;
-const GLint LEVEL_OF_DETAIL  = 0;
-const GLint TEXTURE_BORDER   = 0;
+const char *const WATCHED_DIRECTORIES[] = { "shaders", "assets" };
+const int WATCHED_DIRECTORY_COUNT      = 2;
+
+// Together these cover every sprite, both messages and the HUD
+const GoldenScene GOLDEN_SCENES[] =
+{
+    { "start",        glm::vec3(0.0f),               glm::vec3(0.0f),              Entity::LEFT,  0   },
+    { "sinking",      glm::vec3(0.0f),               glm::vec3(0.0f),              Entity::LEFT,  120 },
+    { "thrust_right", glm::vec3(-1.0f, 1.0f, 0.0f),  glm::vec3(1.0f, 0.0f, 0.0f),  Entity::RIGHT, 90  },
+    { "thrust_up",    glm::vec3(0.0f, -2.0f, 0.0f),  glm::vec3(0.0f, 1.0f, 0.0f),  Entity::UP,    90  },
+    { "win",          glm::vec3(3.5f, -1.2f, 0.0f),  glm::vec3(0.0f),              Entity::DOWN,  240 },
+    { "lost",         glm::vec3(1.5f, 1.7f, 0.0f),   glm::vec3(0.0f),              Entity::DOWN,  240 },
+};
+const int GOLDEN_SCENE_COUNT   = sizeof(GOLDEN_SCENES) / sizeof(GOLDEN_SCENES[0]);
+const int GOLDEN_TIMING_FRAMES = 31;   // renders timed per scene; the median is reported
+
+// Largest on-screen size of each texture in pixels: 64 pixels per world unit
+// at 640 x 480. Sprites drawn smaller than their source are filtered down to
+// this once, with a mip chain, instead of being sampled at full size every frame.
+const int PIXELS_PER_UNIT = WINDOW_WIDTH / 10;
 
 // ––––– GLOBAL VARIABLES ––––– //
 GameState g_state;
 
 SDL_Window* g_display_window;
-bool g_game_is_running = true;
+std::atomic<bool> g_game_is_running(true);
 bool g_player_win = false;
 bool g_player_lost = false;
 
 ShaderProgram g_program;
-glm::mat4 g_view_matrix, g_projection_matrix;
+GLuint g_font_texture_id;
+Hud* g_hud;
+AudioEngine g_audio;
+bool g_was_thrusting = false;
+int g_score = 0;
+AnimationLibrary g_player_animations;
+Arena g_level_arena(LEVEL_ARENA_SIZE);
+GLuint g_level_textures[MAX_LEVEL_TEXTURES];
+int g_level_texture_count = 0;
+AssetWatcher g_asset_watcher;
+InputSystem g_input;
+FrameCapture g_capture;
+glm::mat4 g_projection_matrix;
+Camera g_camera(VIEW_HALF_SIZE, CAMERA_FOLLOW_RATE);
+Broadphase g_broadphase(BROADPHASE_CELL_SIZE);
+LevelStream g_level_stream;
+TerrainMesh g_terrain_mesh;
+CollisionMaskImage g_chest_mask, g_jellyfish_mask, g_player_mask;
+const char* g_level_filepath = NULL;
+
+// The simulation thread owns g_state and the game flags once it starts; the
+// main thread only sees them through the published snapshots
+TripleBuffer<RenderSnapshot> g_snapshots;
+std::thread g_simulation_thread;
+int g_tick_count = 0;
+LoopTimings g_tick_timings, g_frame_timings;
+FramePacer g_pacer;
+
+// Set by anything outside the snapshots that changes the picture: reloaded
+// assets, a window that was covered or resized
+bool g_needs_redraw = true;
+RenderSnapshot g_drawn_snapshot;
+int g_unchanged_frames = 0;
 
 float g_previous_ticks = 0.0f;
 float g_accumulator = 0.0f;
 
 // ––––– GENERAL FUNCTIONS ––––– //
-GLuint load_texture(const char* filepath)
+double milliseconds_since(Uint64 start)
 {
-    int width, height, number_of_components;
-    unsigned char* image = stbi_load(filepath, &width, &height, &number_of_components, STBI_rgb_alpha);
+    return (SDL_GetPerformanceCounter() - start) * MILLISECONDS_IN_SECOND / SDL_GetPerformanceFrequency();
+}
+
+GLuint load_texture(const char* filepath, const TextureOptions &options = TextureOptions())
+{
+    TextureImage image;
+    GLuint textureID = create_texture_direct(filepath, options, image);
     
-    if (image == NULL)
+    if (textureID == 0)
     {
-        LOG("Unable to load image. Make sure the path is correct.");
-        assert(false);
+        if (!build_texture_image(filepath, options, image))
+        {
+            LOG("Unable to load image. Make sure the path is correct.");
+            assert(false);
+        }
+        
+        textureID = create_texture(image, options);
     }
     
-    GLuint textureID;
-    glGenTextures(NUMBER_OF_TEXTURES, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, LEVEL_OF_DETAIL, GL_RGBA, width, height, TEXTURE_BORDER, GL_RGBA, GL_UNSIGNED_BYTE, image);
-    
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    g_asset_watcher.track_texture(filepath, textureID, options, image);
     
+    return textureID;
+}
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+GLuint load_level_texture(const char* filepath, const TextureOptions &options = TextureOptions())
+{
+    GLuint texture_id = load_texture(filepath, options);
     
-    stbi_image_free(image);
+    assert(g_level_texture_count < MAX_LEVEL_TEXTURES);
+    g_level_textures[g_level_texture_count++] = texture_id;
     
-    return textureID;
+    return texture_id;
 }
 
-void initialise()
+// On a level wider than the screen the backdrop travels with the camera
+void follow_with_background()
 {
-    SDL_Init(SDL_INIT_VIDEO);
-    g_display_window = SDL_CreateWindow("Lunar Lander",
-                                      SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                                      WINDOW_WIDTH, WINDOW_HEIGHT,
-                                      SDL_WINDOW_OPENGL);
+    if (!g_level_stream.is_open()) return;
     
-    SDL_GLContext context = SDL_GL_CreateContext(g_display_window);
-    SDL_GL_MakeCurrent(g_display_window, context);
-    
-#ifdef _WINDOWS
-    glewInit();
-#endif
+    glm::vec3 position = glm::vec3(g_camera.get_position(), 0.0f) + BACKGROUND_OFFSET;
+    g_state.background->set_position(position);
+    g_state.background->m_model_matrix = glm::scale(glm::translate(glm::mat4(1.0f), position), BACKGROUND_SIZE);
+}
+
+void load_mask_image(const char* filepath, CollisionMaskImage &image)
+{
+    if (!load_collision_mask_image(filepath, image))
+    {
+        LOG("Unable to load the collision mask for " << filepath << ". Make sure the path is correct.");
+        assert(false);
+    }
+}
+
+const CollisionMask* create_level_mask(const CollisionMaskImage &image, float width, float height)
+{
+    const CollisionMask* mask = create_collision_mask(g_level_arena, image, 0.0f, 0.0f, 1.0f, 1.0f, width, height);
+    if (mask == NULL)
+    {
+        LOG("Level arena is too small for this level.");
+        assert(false);
+    }
     
-    glViewport(VIEWPORT_X, VIEWPORT_Y, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    return mask;
+}
+
+void load_level()
+{
+    // ––––– TEXTURE IDS ––––– //
+    TextureOptions message_options;
+    message_options.filter         = FILTER_LINEAR;
+    message_options.mipmaps        = true;
+    message_options.display_width  = (int) (5.0f * PIXELS_PER_UNIT);
+    message_options.display_height = (int) (3.0f * PIXELS_PER_UNIT);
     
-    g_program.Load(V_SHADER_PATH, F_SHADER_PATH);
+    TextureOptions chest_options = message_options;
+    chest_options.display_width  = (int) (1.75f * PIXELS_PER_UNIT);
+    chest_options.display_height = (int) (1.25f * PIXELS_PER_UNIT);
     
-    g_view_matrix = glm::mat4(1.0f);
-    g_projection_matrix = glm::ortho(-5.0f, 5.0f, -3.75f, 3.75f, -1.0f, 1.0f);
+    TextureOptions jellyfish_options = message_options;   // sized for the biggest jellyfish
+    jellyfish_options.display_width  = (int) (1.5f * PIXELS_PER_UNIT);
+    jellyfish_options.display_height = (int) (2.0f * PIXELS_PER_UNIT);
     
-    g_program.SetProjectionMatrix(g_projection_matrix);
-    g_program.SetViewMatrix(g_view_matrix);
+    TextureOptions background_options = message_options;
+    background_options.display_width  = (int) (11.5f * PIXELS_PER_UNIT);
+    background_options.display_height = (int) (8.0f * PIXELS_PER_UNIT);
     
-    glUseProgram(g_program.programID);
+    GLuint win_platform_texture_id = load_level_texture(WIN_PLATFORM_FILEPATH, chest_options);
+    GLuint win_message_texture_id = load_level_texture(WIN_MESSAGE_FILEPATH, message_options);
+    GLuint lose_platform_texture_id = load_level_texture(LOSE_PLATFORM_FILEPATH, jellyfish_options);
+    GLuint lose_message_texture_id = load_level_texture(LOSE_MESSAGE_FILEPATH, message_options);
+    GLuint background_texture_id = load_level_texture(BACKGROUND_FILEPATH, background_options);
+    // Sprite sheet frames stay unfiltered so neighbouring frames do not bleed in
+    GLuint player_texture_id = load_level_texture(SPRITESHEET_FILEPATH);
     
-    glClearColor(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY);
+    // ––––– LEVEL MEMORY ––––– //
+    // Everything the level owns is bump-allocated from the level arena in one pass
+    g_state.background = g_level_arena.create<Entity>();
+    g_state.platforms  = g_level_arena.create_array<Entity>(PLATFORM_COUNT);
+    g_state.messages   = g_level_arena.create_array<Entity>(2);
+    g_state.player     = g_level_arena.create<Entity>();
+    g_state.currents   = g_level_arena.create<FlowField>(g_level_arena, glm::vec2(-5.0f, -3.75f),
+                                                         FLOW_COLS, FLOW_ROWS, FLOW_CELL_SIZE, MAX_EDDIES);
     
-    // ––––– TEXTURE IDS ––––– //
-    GLuint win_platform_texture_id = load_texture(WIN_PLATFORM_FILEPATH);
-    GLuint win_message_texture_id = load_texture(WIN_MESSAGE_FILEPATH);
-    GLuint lose_platform_texture_id = load_texture(LOSE_PLATFORM_FILEPATH);
-    GLuint lose_message_texture_id = load_texture(LOSE_MESSAGE_FILEPATH);
-    GLuint background_texture_id = load_texture(BACKGROUND_FILEPATH);
+    if (g_state.background == NULL || g_state.platforms == NULL || g_state.messages == NULL ||
+        g_state.player == NULL || g_state.currents == NULL)
+    {
+        LOG("Level arena is too small for this level.");
+        assert(false);
+    }
     
     // Background
-    g_state.background = new Entity();
     g_state.background->m_texture_id = background_texture_id;
-    g_state.background->set_position(glm::vec3(0.0f, -1.5f, 0.0f));
-    g_state.background->set_size(glm::vec3(11.5f, 8.0f, 1.0f));
-    
+    g_state.background->set_position(BACKGROUND_OFFSET);
+    g_state.background->set_width(BACKGROUND_SIZE.x);
+    g_state.background->set_height(BACKGROUND_SIZE.y);
+    g_state.background->set_size(BACKGROUND_SIZE);
     
-    g_state.platforms = new Entity[PLATFORM_COUNT];
-
     // Treasure chests
     g_state.platforms[3].m_texture_id = win_platform_texture_id;
     g_state.platforms[3].set_position(glm::vec3(-3.5f, -2.5f, 0.0f));
@@ -200,8 +470,26 @@ void initialise()
     g_state.platforms[2].update(0.0f, NULL, 0, g_player_win, g_player_lost);
     g_state.platforms[2].set_size(glm::vec3(0.8f, 2.0f, 1.0f));
     
+    // Pixel-accurate collisions, once the boxes overlap
+    for (int i = 0; i < PLATFORM_COUNT; i++)
+    {
+        Entity &platform = g_state.platforms[i];
+        platform.m_collision_mask = create_level_mask(platform.get_entity_type() == WIN_PLATFORM ? g_chest_mask
+                                                                                                 : g_jellyfish_mask,
+                                                      platform.get_width(), platform.get_height());
+    }
+    
+    // A streamed level brings its own platforms, chunk by chunk, in place of these
+    bool is_streamed = g_level_filepath != NULL &&
+                       g_level_stream.initialise(g_level_filepath, g_level_arena, &g_broadphase,
+                                                 win_platform_texture_id, lose_platform_texture_id,
+                                                 &g_chest_mask, &g_jellyfish_mask);
+    if (!is_streamed)
+    {
+        for (int i = 0; i < PLATFORM_COUNT; i++) g_broadphase.insert(&g_state.platforms[i]);
+    }
+    
     // ––––– MESSAGES ––––– //
-    g_state.messages = new Entity[2];
     g_state.messages[0].m_texture_id = win_message_texture_id;
     g_state.messages[1].m_texture_id = lose_message_texture_id;
     for (int i = 0; i < 2; i++)
@@ -213,34 +501,231 @@ void initialise()
         g_state.messages[i].deactivate();
     }
     
+    // ––––– WATER CURRENTS ––––– //
+    // One node every half unit across the visible area
+    g_state.currents->set_base_current(glm::vec2(0.15f, 0.0f));
+    g_state.currents->add_eddy({ glm::vec2(-2.0f, 1.0f), glm::vec2(0.3f,  0.1f),  1.5f, 0.6f });
+    g_state.currents->add_eddy({ glm::vec2( 2.5f, -1.0f), glm::vec2(-0.2f, 0.15f), 1.25f, -0.5f });
+    g_state.currents->set_time_varying(true);
+    g_state.currents->rebuild();
+    
     // ––––– PLAYER ––––– //
     // Existing
-    g_state.player = new Entity();
     g_state.player->set_position(glm::vec3(0.0f));
     g_state.player->set_movement(glm::vec3(0.0f));
     g_state.player->set_entity_type(PLAYER);
     g_state.player->m_speed = 1.0f;
     g_state.player->set_acceleration(glm::vec3(0.0f, -4.905f, 0.0f));
-    g_state.player->m_texture_id = load_texture(SPRITESHEET_FILEPATH);
+    g_state.player->m_texture_id = player_texture_id;
     
     // Walking
-    g_state.player->m_walking[g_state.player->LEFT]  = new int[4] { 4,   5,  6,  7 };
-    g_state.player->m_walking[g_state.player->RIGHT] = new int[4] { 8,   9, 10, 12 };
-    g_state.player->m_walking[g_state.player->UP]    = new int[4] { 12, 13, 14, 15 };
-    g_state.player->m_walking[g_state.player->DOWN]  = new int[4] { 0,   1,  2,  3 };
+    if (!g_player_animations.load(g_level_arena, SPRITESHEET_ANIM_FILEPATH))
+    {
+        LOG("Unable to load player animations. Make sure the path is correct.");
+        assert(false);
+    }
+    g_state.player->m_walking[g_state.player->LEFT]  = g_player_animations.get_clip("left");
+    g_state.player->m_walking[g_state.player->RIGHT] = g_player_animations.get_clip("right");
+    g_state.player->m_walking[g_state.player->UP]    = g_player_animations.get_clip("up");
+    g_state.player->m_walking[g_state.player->DOWN]  = g_player_animations.get_clip("down");
+    if (!g_player_animations.build_masks(g_level_arena, g_player_mask, PLAYER_SPRITE_SIZE, PLAYER_SPRITE_SIZE))
+    {
+        LOG("Level arena is too small for this level.");
+        assert(false);
+    }
 
-    g_state.player->m_animation_indices = g_state.player->m_walking[g_state.player->LEFT];  // start George looking left
-    g_state.player->m_animation_frames = 4;
+    g_state.player->set_animation(g_state.player->m_walking[g_state.player->LEFT]);  // start George looking left
     g_state.player->m_animation_index  = 0;
     g_state.player->m_animation_time   = 0.0f;
-    g_state.player->m_animation_cols   = 4;
-    g_state.player->m_animation_rows   = 4;
     g_state.player->set_height(0.9f);
     g_state.player->set_width(0.9f);
     
     // Jumping
     g_state.player->m_jumping_power = 3.0f;
     
+    // Fuel
+    g_state.player->set_fuel(PLAYER_FUEL);
+    g_state.player->set_fuel_burn_rate(PLAYER_FUEL_BURN_RATE);
+    
+    // ––––– CAMERA AND TERRAIN ––––– //
+    if (is_streamed)
+    {
+        g_state.player->set_position(glm::vec3(g_level_stream.get_spawn_x(), g_level_stream.get_spawn_y(), 0.0f));
+        g_camera.set_bounds(glm::vec2(g_level_stream.get_min_x(), g_level_stream.get_min_y()),
+                            glm::vec2(g_level_stream.get_max_x(), g_level_stream.get_max_y()));
+        g_level_stream.load_around(g_level_stream.get_spawn_x(), g_level_stream.get_spawn_y());
+    }
+    else
+    {
+        g_camera.set_bounds(LEVEL_MIN, LEVEL_MAX);
+    }
+    
+    // The seabed runs the width of the level, however far it streams
+    float level_min_x = is_streamed ? g_level_stream.get_min_x() : LEVEL_MIN.x;
+    float level_max_x = is_streamed ? g_level_stream.get_max_x() : LEVEL_MAX.x;
+    g_state.terrain = g_level_arena.create<Terrain>(level_min_x, level_max_x - level_min_x, TERRAIN_SPACING,
+                                                    TERRAIN_BASE_Y, TERRAIN_AMPLITUDE, SEABED_Y, TERRAIN_SEED);
+    if (g_state.terrain == NULL)
+    {
+        LOG("Level arena is too small for this level.");
+        assert(false);
+    }
+    g_terrain_mesh.set_terrain(g_state.terrain);
+    
+    g_camera.snap_to(glm::vec2(g_state.player->get_position()));
+    follow_with_background();
+}
+
+void unload_level()
+{
+    LOG("Level arena: " << g_level_arena.get_used() << " bytes in " << g_level_arena.get_allocations()
+        << " allocations, high water " << g_level_arena.get_high_water() << " of "
+        << g_level_arena.get_capacity() << " bytes.");
+    
+    g_level_stream.shutdown();
+    g_terrain_mesh.set_terrain(NULL);
+    g_level_arena.reset();
+    g_state = GameState();
+    g_broadphase.clear();
+    
+    for (int i = 0; i < g_level_texture_count; i++) g_asset_watcher.untrack_texture(g_level_textures[i]);
+    glDeleteTextures(g_level_texture_count, g_level_textures);
+    g_level_texture_count = 0;
+}
+
+bool is_on_screen(const Entity *entity)
+{
+    glm::vec3 position = entity->get_position();
+    glm::vec2 half     = glm::vec2(entity->get_width(), entity->get_height()) * 0.5f;
+    glm::vec2 view_min = g_camera.get_min(), view_max = g_camera.get_max();
+    
+    return position.x + half.x >= view_min.x && position.x - half.x <= view_max.x &&
+           position.y + half.y >= view_min.y && position.y - half.y <= view_max.y;
+}
+
+void publish_snapshot()
+{
+    RenderSnapshot &snapshot = g_snapshots.get_back();
+    
+    snapshot.view_matrix = g_camera.get_view_matrix();
+    snapshot.view_min    = g_camera.get_min();
+    snapshot.view_max    = g_camera.get_max();
+    
+    snapshot.background = g_state.background->get_snapshot();
+    if (!is_on_screen(g_state.background)) snapshot.background.is_active = false;
+    snapshot.player     = g_state.player->get_snapshot();
+    
+    // Only what the grid finds under the camera reaches the renderer, however big the level
+    static Entity* visible[MAX_VISIBLE_PLATFORMS];
+    snapshot.platform_count = g_broadphase.query(g_camera.get_min(), g_camera.get_max(), visible,
+                                                 MAX_VISIBLE_PLATFORMS);
+    for (int i = 0; i < snapshot.platform_count; i++) snapshot.platforms[i] = visible[i]->get_snapshot();
+    
+    for (int i = 0; i < 2; i++) snapshot.messages[i] = g_state.messages[i].get_snapshot();
+    
+    snapshot.fuel     = g_state.player->get_fuel();
+    snapshot.velocity = g_state.player->get_velocity();
+    glm::vec3 position = g_state.player->get_position();
+    snapshot.altitude = position.y - g_state.player->get_height() / 2.0f - g_state.terrain->get_height(position.x);
+    snapshot.score    = g_score;
+    snapshot.tick     = g_tick_count;
+    
+    g_snapshots.publish();
+}
+
+void initialise(const LaunchOptions &options)
+{
+    // SDL's offscreen driver gets its context from EGL without any surface, so
+    // headless runs need neither a display nor a GPU (Mesa's llvmpipe will do).
+    // An SDL_VIDEODRIVER already set in the environment wins.
+    if (options.headless) SDL_setenv("SDL_VIDEODRIVER", "offscreen", 0);
+    g_level_filepath = options.level_filepath;
+    
+    SDL_Init(SDL_INIT_VIDEO);
+    g_input.initialise();
+    
+    g_display_window = SDL_CreateWindow("Lunar Lander",
+                                      SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                      WINDOW_WIDTH, WINDOW_HEIGHT,
+                                      SDL_WINDOW_OPENGL | (options.headless ? SDL_WINDOW_HIDDEN : 0));
+    
+    SDL_GLContext context = SDL_GL_CreateContext(g_display_window);
+    SDL_GL_MakeCurrent(g_display_window, context);
+    
+#ifdef _WINDOWS
+    glewInit();
+#endif
+    
+    glViewport(VIEWPORT_X, VIEWPORT_Y, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    
+    if (options.headless || options.capture_format != CAPTURE_NONE)
+    {
+        if (!g_capture.initialise(WINDOW_WIDTH, WINDOW_HEIGHT, options.headless, options.capture_format,
+                                  options.capture_path))
+        {
+            LOG("Unable to start the capture.");
+            assert(false);
+        }
+        
+        if (options.capture_format == CAPTURE_RAW_VIDEO)
+        {
+            LOG("Recording raw video; encode it with: ffmpeg -f rawvideo -pixel_format rgb24 -video_size "
+                << WINDOW_WIDTH << "x" << WINDOW_HEIGHT << " -framerate " << (int) (1.0f / FIXED_TIMESTEP + 0.5f)
+                << " -i " << options.capture_path << " capture.mp4");
+        }
+    }
+    
+    // Linked shader binaries and built textures are cached per user so later
+    // launches skip the GLSL compile and the PNG decode
+    char* pref_path = SDL_GetPrefPath(PREF_ORGANISATION, PREF_APPLICATION);
+    if (pref_path != NULL)
+    {
+        g_program.binaryCacheDirectory = pref_path;
+        set_texture_cache_directory(pref_path);
+        SDL_free(pref_path);
+    }
+
+    // Filtered art ships pre-compressed to BC7; drivers without BPTC decode it
+    // on the CPU instead
+    bool compressed_upload = detect_compressed_texture_support();
+    use_compressed_textures(compressed_upload);
+    LOG("BC7 textures: " << (compressed_upload ? "uploaded compressed" : "decoded on the CPU"));
+
+    g_program.Load(V_SHADER_PATH, F_SHADER_PATH);
+    
+    if (options.hot_reload && g_asset_watcher.initialise(WATCHED_DIRECTORIES, WATCHED_DIRECTORY_COUNT))
+    {
+        g_asset_watcher.track_shader(&g_program);
+    }
+    
+    // The view matrix follows the camera and is uploaded at the start of every frame
+    g_projection_matrix = glm::ortho(-VIEW_HALF_SIZE.x, VIEW_HALF_SIZE.x, -VIEW_HALF_SIZE.y, VIEW_HALF_SIZE.y,
+                                     -1.0f, 1.0f);
+    
+    g_program.SetProjectionMatrix(g_projection_matrix);
+    
+    glUseProgram(g_program.programID);
+    
+    glClearColor(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY);
+    
+    g_font_texture_id = load_texture(FONT_FILEPATH);
+    g_terrain_mesh.initialise();
+    
+    // Masks come from the same PNGs as the textures but outlive any one level
+    load_mask_image(WIN_PLATFORM_FILEPATH, g_chest_mask);
+    load_mask_image(LOSE_PLATFORM_FILEPATH, g_jellyfish_mask);
+    load_mask_image(SPRITESHEET_FILEPATH, g_player_mask);
+    
+    load_level();
+    
+    // ––––– HUD ––––– //
+    g_hud = new Hud(g_font_texture_id, HUD_TOP_LEFT);
+    publish_snapshot();
+    
+    // ––––– AUDIO ––––– //
+    // The game still runs silently if no audio device (not even the dummy one) opens
+    if (g_audio.initialise(SOUND_EFFECT_FILEPATHS, MUSIC_FILEPATH)) g_audio.play_music();
+    
     // ––––– GENERAL ––––– //
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -248,8 +733,6 @@ void initialise()
 
 void process_input()
 {
-    g_state.player->set_movement(glm::vec3(0.0f));
-    
     SDL_Event event;
     while (SDL_PollEvent(&event))
     {
@@ -260,6 +743,12 @@ void process_input()
                 g_game_is_running = false;
                 break;
                 
+            case SDL_WINDOWEVENT:
+                // The window system may have thrown away what was on screen
+                if (event.window.event == SDL_WINDOWEVENT_EXPOSED ||
+                    event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) g_needs_redraw = true;
+                break;
+                
             case SDL_KEYDOWN:
                 switch (event.key.keysym.sym) {
                     case SDLK_q:
@@ -273,108 +762,683 @@ void process_input()
             default:
                 break;
         }
+        
+        // Movement is queued with its timestamp and applied tick by tick in update()
+        g_input.handle_event(event);
     }
-    
-    const Uint8 *key_state = SDL_GetKeyboardState(NULL);
+}
 
-    // Movement
-    if (key_state[SDL_SCANCODE_LEFT])
+void apply_input(const InputSnapshot &input)
+{
+    Entity *player = g_state.player;
+    player->set_movement(glm::vec3(input.axis, 0.0f));
+    
+    // Face whichever way the thrust mostly points; sideways wins a tie
+    if (input.axis != glm::vec2(0.0f))
     {
-        g_state.player->m_movement.x = -1.0f;
-        g_state.player->m_animation_indices = g_state.player->m_walking[g_state.player->LEFT];
+        int facing = fabs(input.axis.x) >= fabs(input.axis.y) ? (input.axis.x < 0.0f ? player->LEFT : player->RIGHT)
+                                                              : (input.axis.y > 0.0f ? player->UP : player->DOWN);
+        player->set_animation(player->m_walking[facing]);
     }
-    else if (key_state[SDL_SCANCODE_RIGHT])
+    
+    // Thruster sound follows the thrust, with a puff of bubbles as it kicks in
+    bool is_thrusting = glm::length(g_state.player->m_movement) != 0 && g_state.player->get_fuel() > 0.0f &&
+                        !g_player_win && !g_player_lost;
+    if (is_thrusting && !g_was_thrusting)
     {
-        g_state.player->m_movement.x = 1.0f;
-        g_state.player->m_animation_indices = g_state.player->m_walking[g_state.player->RIGHT];
+        g_audio.play_effect(SFX_BUBBLE);
+        g_audio.play_effect(SFX_THRUSTER, -1);
     }
-    else if (key_state[SDL_SCANCODE_UP])
+    else if (!is_thrusting && g_was_thrusting)
     {
-        g_state.player->m_movement.y = 1.0f;
-        g_state.player->m_animation_indices = g_state.player->m_walking[g_state.player->UP];
+        g_audio.stop_effect(SFX_THRUSTER);
     }
-    else if (key_state[SDL_SCANCODE_DOWN])
+    g_was_thrusting = is_thrusting;
+}
+
+void apply_currents(Entity **bodies, int body_count)
+{
+    // Bodies are packed into flat arrays so the field can sample them in one batch
+    static float xs[MAX_CURRENT_BODIES], ys[MAX_CURRENT_BODIES];
+    static float flow_x[MAX_CURRENT_BODIES], flow_y[MAX_CURRENT_BODIES];
+    
+    for (int start = 0; start < body_count; start += MAX_CURRENT_BODIES)
     {
-        g_state.player->m_movement.y = -1.0f;
-        g_state.player->m_animation_indices = g_state.player->m_walking[g_state.player->DOWN];
+        int count = std::min(body_count - start, MAX_CURRENT_BODIES);
+        
+        for (int i = 0; i < count; i++)
+        {
+            glm::vec3 position = bodies[start + i]->get_position();
+            xs[i] = position.x;
+            ys[i] = position.y;
+        }
+        
+        g_state.currents->sample(xs, ys, flow_x, flow_y, count);
+        
+        for (int i = 0; i < count; i++)
+        {
+            bodies[start + i]->set_current(glm::vec3(flow_x[i], flow_y[i], 0.0f));
+        }
     }
+}
+
+// Collision candidates are the platforms the grid has anywhere near this tick's
+// movement. `nearby` needs room for MAX_NEARBY_PLATFORMS.
+int query_nearby_platforms(const Entity *body, Entity **nearby)
+{
+    glm::vec3 position = body->get_position();
+    glm::vec3 velocity = body->get_velocity();
+    glm::vec2 reach    = glm::vec2(body->get_width(), body->get_height()) * 0.5f +
+                         glm::vec2(fabs(velocity.x), fabs(velocity.y)) * FIXED_TIMESTEP +
+                         glm::vec2(COLLISION_SWEEP_SLACK);
     
-    // Normalize
-    if (glm::length(g_state.player->m_movement) > 1.0f)
+    return g_broadphase.query(glm::vec2(position) - reach, glm::vec2(position) + reach, nearby,
+                              MAX_NEARBY_PLATFORMS);
+}
+
+void simulate_tick()
+{
+    Entity *player = g_state.player;
+    
+    g_state.currents->update(FIXED_TIMESTEP);
+    apply_currents(&player, 1);
+    
+    // Streamed chunks come and go around the player before the grid is asked about it
+    glm::vec3 position = player->get_position();
+    g_level_stream.update(position.x, position.y);
+    
+    Entity* nearby[MAX_NEARBY_PLATFORMS];
+    int nearby_count = query_nearby_platforms(player, nearby);
+    
+    player->update(FIXED_TIMESTEP, nearby, nearby_count, g_player_win, g_player_lost, g_state.terrain);
+    
+    g_camera.follow(glm::vec2(player->get_position()), FIXED_TIMESTEP);
+    follow_with_background();
+}
+
+void update_outcome()
+{
+    if (g_player_win || g_player_lost)
     {
-        g_state.player->m_movement = glm::normalize(g_state.player->m_movement);
+        g_audio.stop_effect(SFX_THRUSTER);
+        g_audio.play_effect(g_player_win ? SFX_WIN : SFX_LOSE);
+    }
+    if (g_player_win)
+    {
+        g_state.messages[0].activate();
+        g_score = SCORE_PER_LANDING + (int) g_state.player->get_fuel() * SCORE_PER_FUEL;
+    }
+    if (g_player_lost)
+    {
+        g_state.messages[1].activate();
     }
 }
 
-void update()
+// Runs the fixed ticks due since the last call and publishes the result.
+// Returns the number of ticks run.
+int update()
 {
+    if (g_player_win || g_player_lost) return 0;
+    
     float ticks = (float)SDL_GetTicks() / MILLISECONDS_IN_SECOND;
     float delta_time = ticks - g_previous_ticks;
     g_previous_ticks = ticks;
     
+    // Captured footage advances one tick per frame, however long the frame took
+    if (g_capture.is_capturing()) delta_time = FIXED_TIMESTEP;
+    
     delta_time += g_accumulator;
     
     if (delta_time < FIXED_TIMESTEP)
     {
         g_accumulator = delta_time;
-        return;
+        return 0;
     }
     
+    int tick_count = 0;
+    
     while (delta_time >= FIXED_TIMESTEP)
     {
-        g_state.player->update(FIXED_TIMESTEP, g_state.platforms, PLATFORM_COUNT,
-                               g_player_win, g_player_lost);
+        Uint64 tick_start = SDL_GetPerformanceCounter();
+        
+        // Each tick sees the input as it stood when its step ends, on the same clock as the events
+        float tick_end = ticks - (delta_time - FIXED_TIMESTEP);
+        apply_input(g_input.next_tick(tick_end, ticks));
+        
+        simulate_tick();
         delta_time -= FIXED_TIMESTEP;
+        
+        g_tick_timings.add(milliseconds_since(tick_start));
+        g_tick_count++;
+        tick_count++;
     }
     
     g_accumulator = delta_time;
-    if (g_player_win)
+    update_outcome();
+    publish_snapshot();
+    
+    return tick_count;
+}
+
+// ––––– SIMULATION THREAD ––––– //
+// Ticks at the fixed rate whatever the display does: a slow swap only means
+// the renderer skips snapshots, never that physics waits for it
+void simulation_loop()
+{
+    while (g_game_is_running)
     {
-        g_state.messages[0].activate();
+        update();
+        
+        // Sleep until the next tick is due. SDL_Delay rounds down and may
+        // oversleep by a millisecond; the accumulator catches up either way.
+        float wait = FIXED_TIMESTEP - g_accumulator;
+        SDL_Delay((Uint32) (wait * MILLISECONDS_IN_SECOND));
     }
-    if (g_player_lost)
+}
+
+// Draws the newest published state. With `only_if_changed`, a frame that
+// would look exactly like the one on screen is skipped, swap and all, so the
+// end screens cost next to nothing. Returns whether it drew.
+bool render(bool only_if_changed = false)
+{
+    g_snapshots.acquire();
+    const RenderSnapshot &snapshot = g_snapshots.get_front();
+    
+    g_hud->update(snapshot.fuel, snapshot.velocity, snapshot.altitude, snapshot.score);
+    
+    if (only_if_changed && !g_needs_redraw && !g_hud->is_dirty() && snapshot.looks_like(g_drawn_snapshot))
     {
-        g_state.messages[1].activate();
+        return false;
     }
+    g_needs_redraw   = false;
+    g_drawn_snapshot = snapshot;
+    
+    g_capture.begin_frame();
+    
+    glClear(GL_COLOR_BUFFER_BIT);
+    
+    // World pass, seen through the camera
+    g_program.SetViewMatrix(snapshot.view_matrix);
+    
+    Entity::render_snapshot(&g_program, snapshot.background);
+    
+    g_terrain_mesh.render(&g_program, snapshot.view_min.x, snapshot.view_max.x);
+    
+    Entity::render_snapshot(&g_program, snapshot.player);
+    
+    for (int i = 0; i < snapshot.platform_count; i++) Entity::render_snapshot(&g_program, snapshot.platforms[i]);
+    
+    // Overlay pass, fixed to the screen
+    g_program.SetViewMatrix(glm::mat4(1.0f));
+    
+    g_hud->render(&g_program);
+    
+    for (int i = 0; i < 2; i++) Entity::render_snapshot(&g_program, snapshot.messages[i]);
+    
+    // Read back before the swap, while the back buffer still holds this frame
+    g_capture.end_frame();
+    
+    if (!g_capture.is_offscreen()) SDL_GL_SwapWindow(g_display_window);
+    
+    return true;
 }
 
-void render()
+// ––––– GOLDEN IMAGES ––––– //
+void reset_level()
 {
-    glClear(GL_COLOR_BUFFER_BIT);
+    unload_level();
+    
+    g_player_win    = false;
+    g_player_lost   = false;
+    g_score         = 0;
+    g_was_thrusting = false;
+    
+    load_level();
+    publish_snapshot();
+}
+
+// Renders every scene offscreen and compares it with <directory>/<scene>.png.
+// A failing scene leaves <scene>_actual.png and <scene>_diff.png beside its
+// golden. Returns the number of failures.
+int run_golden_scenes(const char* directory, bool update_goldens, int tolerance)
+{
+    GpuTimer timer;
+    timer.initialise();
+    
+    std::vector<unsigned char> actual, diff;
+    int failures = 0;
+    
+    for (int i = 0; i < GOLDEN_SCENE_COUNT; i++)
+    {
+        const GoldenScene &scene = GOLDEN_SCENES[i];
+        reset_level();
+        
+        g_state.player->set_position(scene.start);
+        g_camera.snap_to(glm::vec2(scene.start));
+        g_state.player->set_animation(g_state.player->m_walking[scene.facing]);
+        
+        for (int tick = 0; tick < scene.ticks && !g_player_win && !g_player_lost; tick++)
+        {
+            g_state.player->set_movement(scene.movement);
+            simulate_tick();
+            update_outcome();
+        }
+        publish_snapshot();
+        
+        reset_render_stats();
+        render();
+        RenderStats stats = render_stats();
+        g_capture.read_frame(actual);
+        
+        // Median of repeated renders of the same state, so one slow frame does not skew the timings
+        double gpu_milliseconds[GOLDEN_TIMING_FRAMES], cpu_milliseconds[GOLDEN_TIMING_FRAMES];
+        for (int frame = 0; frame < GOLDEN_TIMING_FRAMES; frame++)
+        {
+            Uint64 start = SDL_GetPerformanceCounter();
+            timer.begin();
+            render();
+            cpu_milliseconds[frame] = milliseconds_since(start);
+            gpu_milliseconds[frame] = timer.end();
+        }
+        std::sort(gpu_milliseconds, gpu_milliseconds + GOLDEN_TIMING_FRAMES);
+        std::sort(cpu_milliseconds, cpu_milliseconds + GOLDEN_TIMING_FRAMES);
+        
+        char gpu_time[32] = "n/a";
+        if (timer.is_supported())
+        {
+            snprintf(gpu_time, sizeof(gpu_time), "%.3f", gpu_milliseconds[GOLDEN_TIMING_FRAMES / 2]);
+        }
+        
+        char timings[128];
+        snprintf(timings, sizeof(timings), "%d draws, %d vertices | GPU %s ms, CPU %.3f ms",
+                 stats.draw_calls, stats.vertices, gpu_time, cpu_milliseconds[GOLDEN_TIMING_FRAMES / 2]);
+        
+        std::string golden_path = std::string(directory) + "/" + scene.name + ".png";
+        
+        if (update_goldens)
+        {
+            bool is_written = write_png(golden_path.c_str(), actual.data(), WINDOW_WIDTH, WINDOW_HEIGHT, 3);
+            if (!is_written) failures++;
+            LOG(scene.name << ": " << (is_written ? "wrote " : "UNABLE TO WRITE ") << golden_path << " | " << timings);
+            continue;
+        }
+        
+        int width, height, number_of_components;
+        unsigned char* golden = stbi_load(golden_path.c_str(), &width, &height, &number_of_components, STBI_rgb);
+        
+        if (golden == NULL || width != WINDOW_WIDTH || height != WINDOW_HEIGHT)
+        {
+            LOG(scene.name << ": FAILED, " << (golden == NULL ? "no golden image at " : "wrong size golden image at ")
+                << golden_path << " (create it with --golden-update) | " << timings);
+            if (golden != NULL) stbi_image_free(golden);
+            failures++;
+            continue;
+        }
+        
+        diff.resize(actual.size());
+        ImageDifference difference = compare_images(actual.data(), golden, WINDOW_WIDTH, WINDOW_HEIGHT, tolerance,
+                                                    diff.data());
+        stbi_image_free(golden);
+        
+        bool has_passed = difference.pixels_over == 0;
+        LOG(scene.name << ": " << (has_passed ? "ok" : "FAILED") << ", " << difference.pixels_over
+            << " pixels over tolerance " << tolerance << ", max difference " << difference.max_difference
+            << " | " << timings);
+        
+        if (!has_passed)
+        {
+            std::string prefix = std::string(directory) + "/" + scene.name;
+            write_png((prefix + "_actual.png").c_str(), actual.data(), WINDOW_WIDTH, WINDOW_HEIGHT, 3);
+            write_png((prefix + "_diff.png").c_str(), diff.data(), WINDOW_WIDTH, WINDOW_HEIGHT, 3);
+            failures++;
+        }
+    }
+    
+    timer.shutdown();
     
-    g_state.background->render(&g_program);
+    LOG(GOLDEN_SCENE_COUNT - failures << " of " << GOLDEN_SCENE_COUNT << " golden scenes passed.");
+    return failures;
+}
+
+// ––––– TRAINING BRIDGE ––––– //
+void observe_lander(const Entity &lander, float *observation)
+{
+    glm::vec3 position = lander.get_position();
+    glm::vec3 velocity = lander.get_velocity();
     
-    g_state.player->render(&g_program);
+    observation[0] = position.x;
+    observation[1] = position.y;
+    observation[2] = velocity.x;
+    observation[3] = velocity.y;
+    observation[4] = lander.get_fuel() / PLAYER_FUEL;
+    observation[5] = position.y - lander.get_height() / 2.0f - g_state.terrain->get_height(position.x);
+}
+
+// Every lander's range finders in one batch: the distance along each ray to
+// the nearest jellyfish, as a fraction of BRIDGE_SENSOR_RANGE (1 when there is
+// none in range), after the lander's other observations
+void sense_jellyfish(RaycastGrid &sensors, const std::vector<Entity> &landers, float *observations)
+{
+    static std::vector<float> origin_x, origin_y, direction_x, direction_y, distances;
+    
+    int ray_count = (int) landers.size() * BRIDGE_SENSOR_RAYS;
+    if ((int) origin_x.size() != ray_count)
+    {
+        origin_x.resize(ray_count);
+        origin_y.resize(ray_count);
+        direction_x.resize(ray_count);
+        direction_y.resize(ray_count);
+        distances.resize(ray_count);
+        
+        for (int i = 0; i < ray_count; i += BRIDGE_SENSOR_RAYS)
+        {
+            ray_fan_directions(BRIDGE_SENSOR_RAYS, &direction_x[i], &direction_y[i]);
+        }
+    }
     
-    for (int i = 0; i < PLATFORM_COUNT; i++) g_state.platforms[i].render(&g_program);
+    for (size_t i = 0; i < landers.size(); i++)
+    {
+        glm::vec3 position = landers[i].get_position();
+        std::fill_n(&origin_x[i * BRIDGE_SENSOR_RAYS], BRIDGE_SENSOR_RAYS, position.x);
+        std::fill_n(&origin_y[i * BRIDGE_SENSOR_RAYS], BRIDGE_SENSOR_RAYS, position.y);
+    }
     
-    for (int i = 0; i < 2; i++) g_state.messages[i].render(&g_program);
+    RayBatch rays = { origin_x.data(), origin_y.data(), direction_x.data(), direction_y.data(), ray_count };
+    sensors.cast(g_broadphase, rays, BRIDGE_SENSOR_RANGE, distances.data(), NULL);
     
-    SDL_GL_SwapWindow(g_display_window);
+    for (size_t i = 0; i < landers.size(); i++)
+    {
+        float* sensed = observations + i * BRIDGE_OBSERVATION_SIZE + (BRIDGE_OBSERVATION_SIZE - BRIDGE_SENSOR_RAYS);
+        for (int ray = 0; ray < BRIDGE_SENSOR_RAYS; ray++)
+        {
+            sensed[ray] = distances[i * BRIDGE_SENSOR_RAYS + ray] / BRIDGE_SENSOR_RANGE;
+        }
+    }
+}
+
+// Every lander's occupancy grid, drawn straight into the bridge's images
+void draw_occupancy(const OccupancyRasterizer &rasterizer, const std::vector<Entity> &landers, Bridge &bridge)
+{
+    static std::vector<float> centre_x, centre_y;
+    centre_x.resize(landers.size());
+    centre_y.resize(landers.size());
+    
+    for (size_t i = 0; i < landers.size(); i++)
+    {
+        glm::vec3 position = landers[i].get_position();
+        centre_x[i] = position.x;
+        centre_y[i] = position.y;
+    }
+    
+    rasterizer.rasterize(g_broadphase, centre_x.data(), centre_y.data(), (int) landers.size(), bridge.get_images(),
+                         bridge.get_image_stride());
+}
+
+void reset_lander(Entity &lander, const Entity &spawn, std::mt19937 &random)
+{
+    std::uniform_real_distribution<float> spread(-BRIDGE_SPAWN_SPREAD, BRIDGE_SPAWN_SPREAD);
+    
+    lander = spawn;
+    lander.set_position(glm::vec3(spread(random), BRIDGE_SPAWN_Y, 0.0f));
+}
+
+// One component of a client's action, clamped to -1 to 1. NaN and infinities
+// (a policy that has diverged) become 0 and are counted in `rejected`: let
+// through, they would spread into the lander's position and every grid lookup
+// made from it.
+float action_axis(float value, int &rejected)
+{
+    if (!std::isfinite(value))
+    {
+        rejected++;
+        return 0.0f;
+    }
+    return std::min(std::max(value, -1.0f), 1.0f);
+}
+
+// Serves a training client through shared memory until it sends BRIDGE_QUIT
+// or its process exits: `env_count` landers in the built-in level, all
+// stepped one tick per request. The level, its currents and the grid are
+// shared; each lander only has its own body and episode. An episode that
+// ends is reported through its done flag and reward, and the lander is
+// respawned in the same step, so its observation is already the next
+// episode's. Returns the exit code.
+int run_bridge(const char* name, int env_count)
+{
+    Bridge bridge;
+    if (env_count <= 0 ||
+        !bridge.create(name, env_count, BRIDGE_OBSERVATION_SIZE, BRIDGE_ACTION_SIZE, (int) OCCUPANCY_GRID_BYTES))
+    {
+        return 1;
+    }
+    LOG("Training bridge: " << env_count << " landers at " << name << "; waiting for a client.");
+    
+    // Every lander starts as a copy of the level's player
+    const Entity spawn = *g_state.player;
+    std::vector<Entity> landers(env_count, spawn);
+    std::vector<Entity*> bodies(env_count);
+    std::vector<int> episode_ticks(env_count, 0);
+    std::mt19937 random(0);
+    RaycastGrid jellyfish_sensors(ray_hits(LOSE_PLATFORM));
+    OccupancyRasterizer rasterizer;
+    rasterizer.set_terrain(g_state.terrain);
+    for (int i = 0; i < env_count; i++) bodies[i] = &landers[i];
+    
+    float* observations = bridge.get_observations();
+    float* actions      = bridge.get_actions();
+    float* rewards      = bridge.get_rewards();
+    uint8_t* dones      = bridge.get_dones();
+    
+    int steps = 0, episodes = 0, wins = 0, losses = 0, rejected_actions = 0;
+    double step_milliseconds = 0.0;
+    
+    BridgeCommand command = bridge.wait_for_request();
+    for (; command != BRIDGE_QUIT && command != BRIDGE_DISCONNECT; command = bridge.wait_for_request())
+    {
+        Uint64 start = SDL_GetPerformanceCounter();
+        
+        if (command == BRIDGE_RESET)
+        {
+            for (int i = 0; i < env_count; i++)
+            {
+                reset_lander(landers[i], spawn, random);
+                episode_ticks[i] = 0;
+                rewards[i]       = 0.0f;
+                dones[i]         = 0;
+            }
+        }
+        else if (command == BRIDGE_STEP)
+        {
+            g_state.currents->update(FIXED_TIMESTEP);
+            apply_currents(bodies.data(), env_count);
+            
+            for (int i = 0; i < env_count; i++)
+            {
+                Entity &lander = landers[i];
+                const float* action = actions + i * BRIDGE_ACTION_SIZE;
+                lander.set_movement(glm::vec3(action_axis(action[0], rejected_actions),
+                                              action_axis(action[1], rejected_actions), 0.0f));
+                
+                Entity* nearby[MAX_NEARBY_PLATFORMS];
+                int nearby_count = query_nearby_platforms(&lander, nearby);
+                
+                bool is_win = false, is_lost = false;
+                lander.update(FIXED_TIMESTEP, nearby, nearby_count, is_win, is_lost, g_state.terrain);
+                
+                // Scored like the game: a landing earns what it would on screen, a sting costs a landing
+                bool is_timed_out = ++episode_ticks[i] >= BRIDGE_EPISODE_TICKS;
+                rewards[i] = is_win  ? (float) (SCORE_PER_LANDING + (int) lander.get_fuel() * SCORE_PER_FUEL)
+                           : is_lost ? (float) -SCORE_PER_LANDING : 0.0f;
+                dones[i]   = is_win || is_lost || is_timed_out;
+                
+                if (dones[i])
+                {
+                    episodes++;
+                    wins   += is_win;
+                    losses += is_lost;
+                    reset_lander(lander, spawn, random);
+                    episode_ticks[i] = 0;
+                }
+            }
+            
+            steps++;
+        }
+        
+        for (int i = 0; i < env_count; i++) observe_lander(landers[i], observations + i * BRIDGE_OBSERVATION_SIZE);
+        sense_jellyfish(jellyfish_sensors, landers, observations);
+        draw_occupancy(rasterizer, landers, bridge);
+        
+        step_milliseconds += milliseconds_since(start);
+        bridge.respond();
+    }
+    
+    LOG("Training bridge: " << steps << " steps of " << env_count << " landers, "
+        << (steps > 0 ? step_milliseconds / steps : 0.0) << " ms per step ("
+        << (step_milliseconds > 0.0 ? steps * (double) env_count / step_milliseconds : 0.0)
+        << " lander ticks per ms); " << episodes << " episodes, " << wins << " landings, " << losses << " stings.");
+    if (rejected_actions > 0)
+    {
+        LOG("Training bridge: " << rejected_actions << " non-finite action components were replaced with 0.");
+    }
+    
+    // The client may still be waiting on its QUIT. One that has gone is
+    // reported; either way the region is removed when `bridge` goes.
+    if (command == BRIDGE_DISCONNECT) LOG("Training bridge: the client exited without sending QUIT.");
+    else                              bridge.respond();
+    return 0;
+}
+
+void report_timings(double seconds)
+{
+    LOG("Simulation: " << g_tick_timings.count << " ticks (" << g_tick_timings.count / seconds << " per second), "
+        << g_tick_timings.get_mean() << " ms mean / " << g_tick_timings.maximum << " ms max per tick.");
+    LOG("Render: " << g_frame_timings.count << " frames (" << g_frame_timings.count / seconds << " per second), "
+        << g_frame_timings.get_mean() << " ms mean / " << g_frame_timings.maximum << " ms max per frame; "
+        << g_unchanged_frames << " unchanged frames not drawn; " << g_snapshots.get_skipped() << " of "
+        << g_snapshots.get_published() << " snapshots never drawn.");
 }
 
 void shutdown()
 {
-    SDL_Quit();
+    // GL objects have to go while the context is still alive
+    g_capture.shutdown();
+    delete g_hud;
+    
+    unload_level();
+    LOG("Terrain: " << g_terrain_mesh.get_builds() << " chunk buffers built.");
+    g_terrain_mesh.shutdown();
     
-    delete [] g_state.platforms;
-    delete g_state.player;
+    g_asset_watcher.shutdown();
+    if (g_audio.is_open()) LOG("Audio: " << g_audio.get_dropped_commands() << " commands dropped on a full queue.");
+    g_audio.shutdown();
+    g_input.shutdown();
+    
+    SDL_Quit();
 }
 
 // ––––– GAME LOOP ––––– //
 int main(int argc, char* argv[])
 {
-    initialise();
+    LaunchOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        if      (strcmp(argv[i], "--hot-reload") == 0)    options.hot_reload    = true;
+        else if (strcmp(argv[i], "--headless") == 0)      options.headless      = true;
+        else if (strcmp(argv[i], "--single-thread") == 0) options.single_thread = true;
+        else if (strcmp(argv[i], "--always-render") == 0) options.render_on_change = false;
+        else if (strcmp(argv[i], "--capture-video") == 0 && i + 1 < argc)
+        {
+            options.capture_format = CAPTURE_RAW_VIDEO;
+            options.capture_path   = argv[++i];
+        }
+        else if (strcmp(argv[i], "--capture-png") == 0 && i + 1 < argc)
+        {
+            options.capture_format = CAPTURE_PNG_SEQUENCE;
+            options.capture_path   = argv[++i];
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) options.frame_limit = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)    options.target_fps  = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--vsync") == 0 && i + 1 < argc)
+        {
+            const char* mode = argv[++i];
+            if      (strcmp(mode, "off") == 0)      options.vsync = VSYNC_OFF;
+            else if (strcmp(mode, "on") == 0)       options.vsync = VSYNC_ON;
+            else if (strcmp(mode, "adaptive") == 0) options.vsync = VSYNC_ADAPTIVE;
+        }
+        else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc)   options.level_filepath   = argv[++i];
+        else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc)  options.golden_directory = argv[++i];
+        else if (strcmp(argv[i], "--golden-update") == 0)          options.update_goldens = true;
+        else if (strcmp(argv[i], "--bridge") == 0 && i + 1 < argc)  options.bridge_name    = argv[++i];
+        else if (strcmp(argv[i], "--envs") == 0 && i + 1 < argc)    options.bridge_envs    = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--golden-tolerance") == 0 && i + 1 < argc)
+        {
+            options.golden_tolerance = atoi(argv[++i]);
+        }
+    }
     
+    // Golden images are always of the built-in level, rendered offscreen at a
+    // fixed size whatever the display. Training runs use the built-in level
+    // too and never draw.
+    if (options.golden_directory != NULL || options.bridge_name != NULL)
+    {
+        options.headless       = true;
+        options.level_filepath = NULL;
+    }
+    
+    initialise(options);
+    
+    if (options.golden_directory != NULL)
+    {
+        int failures = run_golden_scenes(options.golden_directory, options.update_goldens,
+                                         options.golden_tolerance);
+        shutdown();
+        return failures == 0 ? 0 : 1;
+    }
+    
+    if (options.bridge_name != NULL)
+    {
+        int result = run_bridge(options.bridge_name, options.bridge_envs);
+        shutdown();
+        return result;
+    }
+    
+    // Captures advance exactly one tick per frame, so they keep the lockstep loop
+    bool is_threaded = !options.single_thread && !g_capture.is_capturing();
+    if (is_threaded) g_simulation_thread = std::thread(simulation_loop);
+    
+    // Captures render offline, as fast as they can
+    g_pacer.initialise(g_capture.is_capturing() ? 0 : options.target_fps, options.vsync);
+    
+    Uint64 loop_start = SDL_GetPerformanceCounter();
+    int frame_count = 0;
     while (g_game_is_running)
     {
+        // Pick up edited shaders and textures; a new program starts with no uniforms set
+        if (g_asset_watcher.poll()) g_program.SetProjectionMatrix(g_projection_matrix);
+        if (g_asset_watcher.has_changed()) g_needs_redraw = true;
+        
         process_input();
-        if (g_player_win == 0 and g_player_lost == 0) {
-            update();
+        if (!is_threaded) update();
+        
+        // Every captured frame has to be drawn, changed or not
+        Uint64 frame_start = SDL_GetPerformanceCounter();
+        if (render(options.render_on_change && !g_capture.is_capturing()))
+        {
+            g_frame_timings.add(milliseconds_since(frame_start));
         }
-        render();
+        else
+        {
+            g_unchanged_frames++;
+        }
+        g_pacer.end_frame();
+        
+        if (++frame_count == options.frame_limit) g_game_is_running = false;
     }
     
+    if (is_threaded) g_simulation_thread.join();
+    report_timings(milliseconds_since(loop_start) / MILLISECONDS_IN_SECOND);
+    g_pacer.report();
+    
     shutdown();
     return 0;
 }
@@ -336,6 +336,32 @@ publish, and distribute this file as you see fit.
 // you have issues compiling it, you can disable it entirely by
 // defining STBI_NO_SIMD.
 //
+// PNG unfiltering (sub/up/avg/paeth) and the palette and grey to RGBA
+// expansions have SSE2/NEON versions too, but they are opt-in: define
+// STBI_PNG_SIMD alongside STB_IMAGE_IMPLEMENTATION. Their output is
+// bit-identical to the generic loops.
+//
+// ===========================================================================
+//
+// Decoding into your own memory
+//
+// stbi_load_png_into() decodes a PNG straight into a buffer you provide, for
+// example a mapped GL pixel buffer, instead of one it mallocs. Once the
+// header is read it calls
+//
+//     stbi_uc *output(void *user, int x, int y, int comp);
+//
+// and you return x*y*comp bytes of writable memory (or NULL to decline).
+// Components are the file's own (a paletted file gives 3 or 4) unless
+// req_comp asks for something else. The decoder only ever writes that
+// memory, never reads it back, so write-combined mappings are fine.
+//
+// The return value is your buffer if it was used. 16-bit, interlaced and
+// colour-keyed (tRNS on grey/RGB) files, a req_comp that needs a conversion,
+// and stbi_set_flip_vertically_on_load() all decode the normal way instead:
+// you get a malloc'd result to stbi_image_free() as usual, and the callback
+// is not called.
+//
 // ===========================================================================
 //
 // HDR image support   (disable by defining STBI_NO_HDR)
@@ -440,6 +466,10 @@ STBIDEF stbi_uc *stbi_load_from_callbacks(stbi_io_callbacks const *clbk  , void
 #ifndef STBI_NO_STDIO
 STBIDEF stbi_uc *stbi_load_from_file  (FILE *f,                  int *x, int *y, int *comp, int req_comp);
 // for stbi_load_from_file, file pointer is left pointing immediately after image
+
+typedef stbi_uc *(*stbi_output_buffer_callback)(void *user, int x, int y, int comp);
+STBIDEF stbi_uc *stbi_load_png_into   (char const *filename,     int *x, int *y, int *comp, int req_comp,
+                                       stbi_output_buffer_callback output, void *user);
 #endif
 
 #ifndef STBI_NO_LINEAR
@@ -739,6 +769,20 @@ static int stbi__sse2_available()
 #define STBI_SIMD_ALIGN(type, name) type name
 #endif
 
+// PNG unfiltering and grey expansion can use the SSE2/NEON loops when
+// STBI_PNG_SIMD is defined; the output is bit-identical to the generic loops.
+#if defined(STBI_PNG_SIMD) && (defined(STBI_SSE2) || defined(STBI_NEON))
+#define STBI__PNG_SIMD
+
+// asked once per image rather than per row: on MSVC it is a cpuid, which
+// under a hypervisor costs about as much as unfiltering a short row
+#ifdef STBI_SSE2
+static int stbi__png_simd_available(void) { return stbi__sse2_available(); }
+#else
+static int stbi__png_simd_available(void) { return 1; }
+#endif
+#endif
+
 ///////////////////////////////////////////////
 //
 //  stbi__context struct and start_xxx functions
@@ -975,27 +1019,29 @@ static unsigned char *stbi__load_main(stbi__context *s, int *x, int *y, int *com
    return stbi__errpuc("unknown image type", "Image not of any known type, or corrupt");
 }
 
-static unsigned char *stbi__load_flip(stbi__context *s, int *x, int *y, int *comp, int req_comp)
+static void stbi__vertical_flip(stbi_uc *result, int w, int h, int depth)
 {
-   unsigned char *result = stbi__load_main(s, x, y, comp, req_comp);
-
-   if (stbi__vertically_flip_on_load && result != NULL) {
-      int w = *x, h = *y;
-      int depth = req_comp ? req_comp : *comp;
-      int row,col,z;
-      stbi_uc temp;
+   int row,col,z;
+   stbi_uc temp;
 
-      // @OPTIMIZE: use a bigger temp buffer and memcpy multiple pixels at once
-      for (row = 0; row < (h>>1); row++) {
-         for (col = 0; col < w; col++) {
-            for (z = 0; z < depth; z++) {
-               temp = result[(row * w + col) * depth + z];
-               result[(row * w + col) * depth + z] = result[((h - row - 1) * w + col) * depth + z];
-               result[((h - row - 1) * w + col) * depth + z] = temp;
-            }
+   // @OPTIMIZE: use a bigger temp buffer and memcpy multiple pixels at once
+   for (row = 0; row < (h>>1); row++) {
+      for (col = 0; col < w; col++) {
+         for (z = 0; z < depth; z++) {
+            temp = result[(row * w + col) * depth + z];
+            result[(row * w + col) * depth + z] = result[((h - row - 1) * w + col) * depth + z];
+            result[((h - row - 1) * w + col) * depth + z] = temp;
          }
       }
    }
+}
+
+static unsigned char *stbi__load_flip(stbi__context *s, int *x, int *y, int *comp, int req_comp)
+{
+   unsigned char *result = stbi__load_main(s, x, y, comp, req_comp);
+
+   if (stbi__vertically_flip_on_load && result != NULL)
+      stbi__vertical_flip(result, *x, *y, req_comp ? req_comp : *comp);
 
    return result;
 }
@@ -1338,10 +1384,74 @@ static stbi_uc stbi__compute_y(int r, int g, int b)
    return (stbi_uc) (((r*77) + (g*150) +  (29*b)) >> 8);
 }
 
+#ifdef STBI__PNG_SIMD
+// grey and grey+alpha to RGBA, the expansion paletteless grey PNGs go through
+static int stbi__convert_row_simd(unsigned char *src, unsigned char *dest, int img_n, int req_comp, unsigned int x)
+{
+   unsigned int i = 0;
+
+   if (req_comp != 4 || (img_n != 1 && img_n != 2)) return 0;
+
+#ifdef STBI_SSE2
+   if (img_n == 1) {
+      __m128i opaque = _mm_set1_epi8((char) 255);
+      for (; i+16 <= x; i += 16) {
+         __m128i g  = _mm_loadu_si128((const __m128i *) (src + i));
+         __m128i gg = _mm_unpacklo_epi8(g, g), ga = _mm_unpacklo_epi8(g, opaque);
+         _mm_storeu_si128((__m128i *) (dest + i*4     ), _mm_unpacklo_epi16(gg, ga));
+         _mm_storeu_si128((__m128i *) (dest + i*4 + 16), _mm_unpackhi_epi16(gg, ga));
+         gg = _mm_unpackhi_epi8(g, g);
+         ga = _mm_unpackhi_epi8(g, opaque);
+         _mm_storeu_si128((__m128i *) (dest + i*4 + 32), _mm_unpacklo_epi16(gg, ga));
+         _mm_storeu_si128((__m128i *) (dest + i*4 + 48), _mm_unpackhi_epi16(gg, ga));
+      }
+   } else {
+      __m128i low = _mm_set1_epi16(0xff);
+      for (; i+8 <= x; i += 8) {
+         __m128i ga = _mm_loadu_si128((const __m128i *) (src + i*2));
+         __m128i g  = _mm_and_si128(ga, low);
+         __m128i gg = _mm_or_si128(g, _mm_slli_epi16(g, 8));
+         _mm_storeu_si128((__m128i *) (dest + i*4     ), _mm_unpacklo_epi16(gg, ga));
+         _mm_storeu_si128((__m128i *) (dest + i*4 + 16), _mm_unpackhi_epi16(gg, ga));
+      }
+   }
+#endif
+
+#ifdef STBI_NEON
+   {
+      uint8x16x4_t rgba;
+      rgba.val[3] = vdupq_n_u8(255);
+      if (img_n == 1) {
+         for (; i+16 <= x; i += 16) {
+            rgba.val[0] = rgba.val[1] = rgba.val[2] = vld1q_u8(src + i);
+            vst4q_u8(dest + i*4, rgba);
+         }
+      } else {
+         for (; i+16 <= x; i += 16) {
+            uint8x16x2_t ga = vld2q_u8(src + i*2);
+            rgba.val[0] = rgba.val[1] = rgba.val[2] = ga.val[0];
+            rgba.val[3] = ga.val[1];
+            vst4q_u8(dest + i*4, rgba);
+         }
+      }
+   }
+#endif
+
+   for (; i < x; ++i) {
+      dest[i*4+0] = dest[i*4+1] = dest[i*4+2] = src[i*img_n];
+      dest[i*4+3] = img_n == 2 ? src[i*2+1] : 255;
+   }
+   return 1;
+}
+#endif
+
 static unsigned char *stbi__convert_format(unsigned char *data, int img_n, int req_comp, unsigned int x, unsigned int y)
 {
    int i,j;
    unsigned char *good;
+#ifdef STBI__PNG_SIMD
+   int simd = stbi__png_simd_available();
+#endif
 
    if (req_comp == img_n) return data;
    STBI_ASSERT(req_comp >= 1 && req_comp <= 4);
@@ -1356,6 +1466,10 @@ static unsigned char *stbi__convert_format(unsigned char *data, int img_n, int r
       unsigned char *src  = data + j * x * img_n   ;
       unsigned char *dest = good + j * x * req_comp;
 
+#ifdef STBI__PNG_SIMD
+      if (simd && stbi__convert_row_simd(src, dest, img_n, req_comp, x)) continue;
+#endif
+
       #define COMBO(a,b)  ((a)*8+(b))
       #define CASE(a,b)   case COMBO(a,b): for(i=x-1; i >= 0; --i, src += a, dest += b)
       // convert source image with img_n components to one with req_comp components;
@@ -3965,6 +4079,10 @@ typedef struct
    stbi__context *s;
    stbi_uc *idata, *expanded, *out;
    int depth;
+   stbi_output_buffer_callback output; // caller's buffer for the final image, may be NULL
+   void *output_user;
+   stbi_uc *target;                    // what output returned for this image
+   int target_is_palette;              // target takes the palette expansion, not the unfilter
 } stbi__png;
 
 
@@ -4001,6 +4119,183 @@ static int stbi__paeth(int a, int b, int c)
 
 static stbi_uc stbi__depth_scale_table[9] = { 0, 0xff, 0x55, 0, 0x11, 0,0,0, 0x01 };
 
+#ifdef STBI__PNG_SIMD
+
+// sub, avg and paeth predict each pixel from the one to its left, so they
+// step one pixel at a time with all of its channels widened to 16 bits in a
+// single vector; "up" has no such dependency and runs 16 bytes at a time.
+#ifdef STBI_SSE2
+typedef __m128i stbi__png_vec;
+
+static stbi__png_vec stbi__png_widen(stbi__uint32 p)
+{
+   return _mm_unpacklo_epi8(_mm_cvtsi32_si128((int) p), _mm_setzero_si128());
+}
+
+static stbi__uint32 stbi__png_narrow(stbi__png_vec v)
+{
+   return (stbi__uint32) _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+}
+
+static stbi__png_vec stbi__png_add_wrap(stbi__png_vec a, stbi__png_vec b)
+{
+   return _mm_and_si128(_mm_add_epi16(a, b), _mm_set1_epi16(0xff));
+}
+
+static stbi__png_vec stbi__png_avg(stbi__png_vec a, stbi__png_vec b)
+{
+   return _mm_srli_epi16(_mm_add_epi16(a, b), 1);
+}
+
+static stbi__png_vec stbi__png_abs(stbi__png_vec v)
+{
+   return _mm_max_epi16(v, _mm_sub_epi16(_mm_setzero_si128(), v));
+}
+
+static stbi__png_vec stbi__png_select(stbi__png_vec mask, stbi__png_vec a, stbi__png_vec b)
+{
+   return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// same decision as stbi__paeth: pa = |b-c|, pb = |a-c|, pc = |a+b-2c|,
+// then a if pa is smallest, else b if pb is, else c
+static stbi__png_vec stbi__png_paeth(stbi__png_vec a, stbi__png_vec b, stbi__png_vec c)
+{
+   stbi__png_vec pa = _mm_sub_epi16(b, c);
+   stbi__png_vec pb = _mm_sub_epi16(a, c);
+   stbi__png_vec pc = stbi__png_abs(_mm_add_epi16(pa, pb));
+   stbi__png_vec smallest;
+   pa = stbi__png_abs(pa);
+   pb = stbi__png_abs(pb);
+   smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+   return stbi__png_select(_mm_cmpeq_epi16(pa, smallest), a,
+                           stbi__png_select(_mm_cmpeq_epi16(pb, smallest), b, c));
+}
+
+static void stbi__png_add_16(stbi_uc *cur, stbi_uc *raw, stbi_uc *prior)
+{
+   __m128i r = _mm_loadu_si128((const __m128i *) raw);
+   __m128i p = _mm_loadu_si128((const __m128i *) prior);
+   _mm_storeu_si128((__m128i *) cur, _mm_add_epi8(r, p));
+}
+#endif // STBI_SSE2
+
+#ifdef STBI_NEON
+typedef int16x8_t stbi__png_vec;
+
+static stbi__png_vec stbi__png_widen(stbi__uint32 p)
+{
+   return vreinterpretq_s16_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(p))));
+}
+
+static stbi__uint32 stbi__png_narrow(stbi__png_vec v)
+{
+   return vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vreinterpretq_u16_s16(v))), 0);
+}
+
+static stbi__png_vec stbi__png_add_wrap(stbi__png_vec a, stbi__png_vec b)
+{
+   return vandq_s16(vaddq_s16(a, b), vdupq_n_s16(0xff));
+}
+
+static stbi__png_vec stbi__png_avg(stbi__png_vec a, stbi__png_vec b)
+{
+   return vshrq_n_s16(vaddq_s16(a, b), 1);
+}
+
+static stbi__png_vec stbi__png_paeth(stbi__png_vec a, stbi__png_vec b, stbi__png_vec c)
+{
+   stbi__png_vec pa = vsubq_s16(b, c);
+   stbi__png_vec pb = vsubq_s16(a, c);
+   stbi__png_vec pc = vabsq_s16(vaddq_s16(pa, pb));
+   stbi__png_vec smallest;
+   pa = vabsq_s16(pa);
+   pb = vabsq_s16(pb);
+   smallest = vminq_s16(pc, vminq_s16(pa, pb));
+   return vbslq_s16(vceqq_s16(pa, smallest), a, vbslq_s16(vceqq_s16(pb, smallest), b, c));
+}
+
+static void stbi__png_add_16(stbi_uc *cur, stbi_uc *raw, stbi_uc *prior)
+{
+   vst1q_u8(cur, vaddq_u8(vld1q_u8(raw), vld1q_u8(prior)));
+}
+#endif // STBI_NEON
+
+// pixels are 3 or 4 bytes; fixed-size copies keep these down to a move or two
+stbi_inline static stbi__uint32 stbi__png_load_pixel(const stbi_uc *p, int n)
+{
+   stbi__uint32 v;
+   if (n == 4) {
+      memcpy(&v, p, 4);
+      return v;
+   }
+   return p[0] | (p[1] << 8) | (p[2] << 16);
+}
+
+stbi_inline static void stbi__png_store_pixel(stbi_uc *p, stbi__uint32 v, int n)
+{
+   if (n == 4) {
+      memcpy(p, &v, 4);
+   } else {
+      p[0] = (stbi_uc) v;
+      p[1] = (stbi_uc) (v >> 8);
+      p[2] = (stbi_uc) (v >> 16);
+   }
+}
+
+// unfilter the rest of a row once its first pixel is done: count pixels of
+// in_bpp bytes from raw into out_bpp bytes at cur (out_bpp == in_bpp+1 adds
+// an opaque alpha). returns 0 for the cases the generic loops should handle.
+static int stbi__png_unfilter_simd(int filter, stbi_uc *cur, stbi_uc *raw, stbi_uc *prior, int count, int in_bpp, int out_bpp)
+{
+   stbi__png_vec zero = stbi__png_widen(0);
+   stbi__png_vec a, b, c = zero;
+   int i;
+
+   if (filter == STBI__F_up && in_bpp == out_bpp) {
+      int n = count * in_bpp, k;
+      for (k=0; k+16 <= n; k += 16)
+         stbi__png_add_16(cur+k, raw+k, prior+k);
+      for (; k < n; ++k)
+         cur[k] = STBI__BYTECAST(raw[k] + prior[k]);
+      return 1;
+   }
+
+   // per-pixel vectors only pay off with 3 or 4 channels, and only for the
+   // filters that predict from the left: "none" without expansion is already
+   // a memcpy, and "up" with expansion has no dependency for them to hide, so
+   // widening each pixel costs more than the generic byte loop (0.91-1.0x)
+   if (in_bpp < 3 || (filter == STBI__F_none && in_bpp == out_bpp) || filter == STBI__F_up) return 0;
+
+   a = stbi__png_widen(stbi__png_load_pixel(cur - out_bpp, in_bpp));
+   if (filter == STBI__F_paeth)
+      c = stbi__png_widen(stbi__png_load_pixel(prior - out_bpp, in_bpp));
+
+   // the first row must not touch prior, so only the filters that use it load it
+   #define STBI__PNG_PIXELS(load_b, predict) \
+      for (i=0; i < count; ++i, raw += in_bpp, cur += out_bpp, prior += out_bpp) { \
+         b = load_b; \
+         a = stbi__png_add_wrap(stbi__png_widen(stbi__png_load_pixel(raw, in_bpp)), predict); \
+         stbi__png_store_pixel(cur, stbi__png_narrow(a), in_bpp); \
+         if (out_bpp != in_bpp) cur[in_bpp] = 255; \
+         c = b; \
+      }
+   #define STBI__PNG_PRIOR stbi__png_widen(stbi__png_load_pixel(prior, in_bpp))
+
+   switch (filter) {
+      case STBI__F_none:         STBI__PNG_PIXELS(zero,            zero);                      break;
+      case STBI__F_sub:          STBI__PNG_PIXELS(zero,            a);                         break;
+      case STBI__F_avg:          STBI__PNG_PIXELS(STBI__PNG_PRIOR, stbi__png_avg(a, b));       break;
+      case STBI__F_paeth:        STBI__PNG_PIXELS(STBI__PNG_PRIOR, stbi__png_paeth(a, b, c));  break;
+      case STBI__F_avg_first:    STBI__PNG_PIXELS(zero,            stbi__png_avg(a, zero));    break;
+      case STBI__F_paeth_first:  STBI__PNG_PIXELS(zero,            a);                         break; // paeth(a,0,0) == a
+   }
+   #undef STBI__PNG_PRIOR
+   #undef STBI__PNG_PIXELS
+   return 1;
+}
+#endif // STBI__PNG_SIMD
+
 // create the png data from post-deflated data
 static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 raw_len, int out_n, stbi__uint32 x, stbi__uint32 y, int depth, int color)
 {
@@ -4014,9 +4309,16 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
    int output_bytes = out_n*bytes;
    int filter_bytes = img_n*bytes;
    int width = x;
+   stbi_uc *target = a->target_is_palette ? NULL : a->target;
+#ifdef STBI__PNG_SIMD
+   int simd = depth == 8 && stbi__png_simd_available();
+#endif
 
    STBI_ASSERT(out_n == s->img_n || out_n == s->img_n+1);
-   a->out = (stbi_uc *) stbi__malloc(x * y * output_bytes); // extra bytes to write off the end into
+   // filtering reads the previous row back, which the caller's buffer may not
+   // allow (or make slow), so with one we filter through two rows of scratch
+   // and copy each row out as soon as it is done
+   a->out = (stbi_uc *) stbi__malloc(target ? 2 * stride : x * y * output_bytes); // extra bytes to write off the end into
    if (!a->out) return stbi__err("outofmem", "Out of memory");
 
    img_width_bytes = (((img_n * x * depth) + 7) >> 3);
@@ -4028,10 +4330,13 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
    }
 
    for (j=0; j < y; ++j) {
-      stbi_uc *cur = a->out + stride*j;
-      stbi_uc *prior = cur - stride;
+      stbi_uc *cur = target ? a->out + stride*(j&1) : a->out + stride*j;
+      stbi_uc *prior = target ? a->out + stride*(~j&1) : cur - stride;
       int filter = *raw++;
 
+      if (target && j > 0)
+         memcpy(target + stride*(j-1), a->out + stride*(~j&1), stride);
+
       if (filter > 4)
          return stbi__err("invalid filter","Corrupt PNG");
 
@@ -4078,6 +4383,13 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
          prior += 1;
       }
 
+#ifdef STBI__PNG_SIMD
+      if (simd && stbi__png_unfilter_simd(filter, cur, raw, prior, x-1, img_n, out_n)) {
+         raw += (x-1)*img_n;
+         continue;
+      }
+#endif
+
       // this is a little gross, so that we don't switch per-pixel or per-component
       if (depth < 8 || img_n == out_n) {
          int nk = (width - 1)*filter_bytes;
@@ -4124,6 +4436,14 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
       }
    }
 
+   if (target) {
+      STBI_ASSERT(depth == 8);
+      if (y > 0)
+         memcpy(target + stride*(y-1), a->out + stride*((y-1)&1), stride);
+      STBI_FREE(a->out);
+      a->out = target;
+   }
+
    // we make a separate pass to expand bits to pixels; for performance,
    // this could run two scanlines behind the above code, so it won't
    // intefere with filtering but will still be in the cache.
@@ -4309,12 +4629,27 @@ static int stbi__expand_png_palette(stbi__png *a, stbi_uc *palette, int len, int
    stbi__uint32 i, pixel_count = a->s->img_x * a->s->img_y;
    stbi_uc *p, *temp_out, *orig = a->out;
 
-   p = (stbi_uc *) stbi__malloc(pixel_count * pal_img_n);
+   p = a->target_is_palette ? a->target : (stbi_uc *) stbi__malloc(pixel_count * pal_img_n);
    if (p == NULL) return stbi__err("outofmem", "Out of memory");
 
    // between here and free(out) below, exitting would leak
    temp_out = p;
 
+#ifdef STBI__PNG_SIMD
+   // palette entries are 4 bytes apart, so each pixel is one 32-bit move; for
+   // 3-byte output the spare byte is overwritten by the next pixel, and the
+   // last pixel is done by hand so nothing lands past the end
+   if (pixel_count > 0) {
+      if (pal_img_n == 3) {
+         for (i=0; i+1 < pixel_count; ++i)
+            memcpy(p + i*3, palette + orig[i]*4, 4);
+         memcpy(p + i*3, palette + orig[i]*4, 3);
+      } else {
+         for (i=0; i < pixel_count; ++i)
+            memcpy(p + i*4, palette + orig[i]*4, 4);
+      }
+   }
+#else
    if (pal_img_n == 3) {
       for (i=0; i < pixel_count; ++i) {
          int n = orig[i]*4;
@@ -4333,6 +4668,7 @@ static int stbi__expand_png_palette(stbi__png *a, stbi_uc *palette, int len, int
          p += 4;
       }
    }
+#endif
    STBI_FREE(a->out);
    a->out = temp_out;
 
@@ -4430,6 +4766,8 @@ static int stbi__parse_png_file(stbi__png *z, int scan, int req_comp)
    z->expanded = NULL;
    z->idata = NULL;
    z->out = NULL;
+   z->target = NULL;
+   z->target_is_palette = 0;
 
    if (!stbi__check_png_header(s)) return 0;
 
@@ -4543,6 +4881,14 @@ static int stbi__parse_png_file(stbi__png *z, int scan, int req_comp)
                s->img_out_n = s->img_n+1;
             else
                s->img_out_n = s->img_n;
+            if (z->output && !interlace && z->depth == 8 && !has_trans && !is_iphone) {
+               // components of the finished image, as set below for palettes
+               int final_n = pal_img_n ? (req_comp >= 3 ? req_comp : pal_img_n) : s->img_out_n;
+               if (!req_comp || req_comp == final_n) {
+                  z->target = z->output(z->output_user, s->img_x, s->img_y, final_n);
+                  z->target_is_palette = z->target != NULL && pal_img_n != 0; // NULL declines
+               }
+            }
             if (!stbi__create_png_image(z, z->expanded, raw_len, s->img_out_n, z->depth, color, interlace)) return 0;
             if (has_trans) {
                if (z->depth == 16) {
@@ -4608,7 +4954,8 @@ static unsigned char *stbi__do_png(stbi__png *p, int *x, int *y, int *n, int req
       *y = p->s->img_y;
       if (n) *n = p->s->img_n;
    }
-   STBI_FREE(p->out);      p->out      = NULL;
+   if (p->out != p->target) STBI_FREE(p->out);
+   p->out = NULL;
    STBI_FREE(p->expanded); p->expanded = NULL;
    STBI_FREE(p->idata);    p->idata    = NULL;
 
@@ -4619,6 +4966,8 @@ static unsigned char *stbi__png_load(stbi__context *s, int *x, int *y, int *comp
 {
    stbi__png p;
    p.s = s;
+   p.output = NULL;
+   p.output_user = NULL;
    return stbi__do_png(&p, x,y,comp,req_comp);
 }
 
@@ -4646,8 +4995,36 @@ static int stbi__png_info(stbi__context *s, int *x, int *y, int *comp)
 {
    stbi__png p;
    p.s = s;
+   p.output = NULL;
+   p.output_user = NULL;
    return stbi__png_info_raw(&p, x, y, comp);
 }
+
+#ifndef STBI_NO_STDIO
+STBIDEF stbi_uc *stbi_load_png_into(char const *filename, int *x, int *y, int *comp, int req_comp,
+                                    stbi_output_buffer_callback output, void *user)
+{
+   FILE *f = stbi__fopen(filename, "rb");
+   stbi__context s;
+   stbi__png p;
+   stbi_uc *result;
+   if (!f) return stbi__errpuc("can't fopen", "Unable to open file");
+   stbi__start_file(&s,f);
+   if (!stbi__png_test(&s)) {
+      fclose(f);
+      return stbi__errpuc("not PNG", "Image not of any known type, or corrupt");
+   }
+   p.s = &s;
+   // flipping happens in place afterwards, which would read the caller's buffer
+   p.output = stbi__vertically_flip_on_load ? NULL : output;
+   p.output_user = user;
+   result = stbi__do_png(&p, x,y,comp,req_comp);
+   fclose(f);
+   if (result && stbi__vertically_flip_on_load)
+      stbi__vertical_flip(result, *x, *y, req_comp ? req_comp : *comp);
+   return result;
+}
+#endif
 #endif
 
 // Microsoft/Windows BMP image
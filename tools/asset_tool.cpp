@@ -0,0 +1,167 @@
+/**
+ * Offline asset builder. Compresses a PNG to the BC7 .bc7 file the game loads
+ * in its place, with the same downscale and mip chain the game would build,
+ * or with --mask builds the sprite's .mask collision mask from its alpha.
+ *
+ * Build from the repository root (no GL or SDL libraries are needed, only
+ * their headers):
+ *
+ *     c++ -std=c++17 -O2 -I. $(sdl2-config --cflags) tools/asset_tool.cpp \
+ *         TextureImage.cpp TextureCompression.cpp CollisionMask.cpp Arena.cpp -o asset_tool
+ *
+ * Usage:
+ *
+ *     asset_tool <input.png> [--mipmaps] [--display <width>x<height>] [-o <output.bc7>]
+ *
+ * The flags must match the TextureOptions main.cpp loads the texture with,
+ * otherwise the game ignores the file. The shipped textures were built with:
+ *
+ *     asset_tool assets/win.png            --mipmaps --display 320x192
+ *     asset_tool assets/lost.png           --mipmaps --display 320x192
+ *     asset_tool assets/treasure_chest.png --mipmaps --display 112x80
+ *     asset_tool assets/jellyfish.png      --mipmaps --display 96x128
+ *     asset_tool assets/background.png     --mipmaps --display 736x512
+ *
+ * The sprite sheet and font are pixel art drawn unfiltered and stay RGBA8.
+ *
+ *     asset_tool <input.png> --mask [-o <output.mask>]
+ *
+ * Masks are at the PNG's own size whatever the flags; the shipped ones are
+ * for assets/treasure_chest.png, assets/jellyfish.png and
+ * assets/player_spritesheet.png.
+ */
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_PNG_SIMD
+#define LOG(argument) std::cout << argument << '\n'
+
+#include <bitset>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include "stb_image.h"
+#include "Texture.h"
+#include "TextureCompression.h"
+#include "CollisionMask.h"
+
+// Peak signal-to-noise over every level, as a quick sanity check on the encoder
+static double peak_signal_to_noise(const TextureImage &original, const TextureImage &decoded)
+{
+    double squared_error = 0.0;
+    for (size_t i = 0; i < original.pixels.size(); i++)
+    {
+        double difference = (double) original.pixels[i] - decoded.pixels[i];
+        squared_error += difference * difference;
+    }
+
+    double mean = squared_error / original.pixels.size();
+    return mean > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mean) : INFINITY;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *input = NULL;
+    std::string output;
+    TextureOptions options;
+    options.filter = FILTER_LINEAR;
+    bool build_mask = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--mipmaps") == 0)
+        {
+            options.mipmaps = true;
+        }
+        else if (strcmp(argv[i], "--display") == 0 && i + 1 < argc)
+        {
+            if (sscanf(argv[++i], "%dx%d", &options.display_width, &options.display_height) != 2)
+            {
+                LOG("--display takes <width>x<height>, got " << argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--mask") == 0)
+        {
+            build_mask = true;
+        }
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            output = argv[++i];
+        }
+        else if (input == NULL && argv[i][0] != '-')
+        {
+            input = argv[i];
+        }
+        else
+        {
+            LOG("Unknown argument " << argv[i]);
+            return 1;
+        }
+    }
+
+    if (input == NULL)
+    {
+        LOG("Usage: asset_tool <input.png> [--mipmaps] [--display <width>x<height>] [-o <output.bc7>]");
+        LOG("       asset_tool <input.png> --mask [-o <output.mask>]");
+        return 1;
+    }
+
+    if (build_mask)
+    {
+        if (output.empty()) output = collision_mask_path(input);
+
+        int width, height, number_of_components;
+        unsigned char *decoded = stbi_load(input, &width, &height, &number_of_components, STBI_rgb_alpha);
+        uint64_t source_hash;
+        if (decoded == NULL || !hash_file(input, source_hash))
+        {
+            LOG("Unable to load image " << input << ". Make sure the path is correct.");
+            if (decoded != NULL) stbi_image_free(decoded);
+            return 1;
+        }
+
+        CollisionMaskImage mask;
+        build_collision_mask_image(decoded, width, height, mask);
+        stbi_image_free(decoded);
+
+        if (!write_collision_mask_image(output.c_str(), mask, source_hash))
+        {
+            LOG("Unable to write " << output << ".");
+            return 1;
+        }
+
+        size_t solid = 0;
+        for (uint64_t word : mask.words) solid += std::bitset<64>(word).count();
+        LOG(output << ": " << width << " x " << height << ", " << 100.0 * solid / ((double) width * height)
+            << "% solid, " << mask.words.size() * sizeof(uint64_t) << " bytes");
+        return 0;
+    }
+
+    if (output.empty()) output = compressed_texture_path(input);
+
+    TextureImage image;
+    if (!build_texture_image(input, options, image))
+    {
+        LOG("Unable to load image " << input << ". Make sure the path is correct.");
+        return 1;
+    }
+
+    uint64_t source_hash;
+    if (!hash_file(input, source_hash)) return 1;
+
+    TextureImage compressed, decoded;
+    compress_texture_image(image, compressed);
+    decompress_texture_image(compressed, decoded);
+
+    if (!write_compressed_texture(output.c_str(), compressed, source_hash, hash_texture_options(options)))
+    {
+        LOG("Unable to write " << output << ".");
+        return 1;
+    }
+
+    LOG(output << ": " << image.width << " x " << image.height << ", " << image.level_count << " levels, "
+        << image.pixels.size() << " -> " << compressed.pixels.size() << " bytes, PSNR "
+        << peak_signal_to_noise(image, decoded) << " dB");
+    return 0;
+}
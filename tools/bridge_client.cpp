@@ -0,0 +1,140 @@
+/**
+ * Reference client for the game's training bridge (see Bridge.h): attaches to
+ * the shared memory a game started with --bridge created, flies every lander
+ * with a simple hand-written policy, and reports throughput and outcomes.
+ *
+ * Build from the repository root (Linux links shm_open from librt on older
+ * glibc):
+ *
+ *     c++ -std=c++17 -O2 -I. tools/bridge_client.cpp Bridge.cpp -o bridge_client -lrt
+ *
+ * Usage, with the game started first or within ten seconds:
+ *
+ *     lunar_lander --bridge /lander --envs 1024
+ *     bridge_client /lander [--steps <count>]
+ *
+ * Observations are x, y, velocity x, velocity y, fuel (0 to 1), altitude and
+ * then the range finders: distances to the nearest jellyfish along a fan of
+ * rays, as fractions of their range. Each lander's image is its occupancy
+ * grid (see Occupancy.h): chest, jellyfish and wall planes of 32 x 32 bytes.
+ * Actions are the thrust axis, -1 to 1 on each component.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "Bridge.h"
+#include "Occupancy.h"
+
+const float CHEST_X[]          = { -3.5f, 3.5f };   // the built-in level's landing spots
+const float SAFE_DESCENT_SPEED = 0.6f;
+const int   ATTACH_ATTEMPTS    = 100;                // a tenth of a second apart
+
+static float clamp_axis(float value)
+{
+    return value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+}
+
+// Steer over the nearer chest and keep the descent slow
+static void choose_action(const float *observation, float *action)
+{
+    float x = observation[0], velocity_x = observation[2], velocity_y = observation[3];
+
+    float target = std::fabs(x - CHEST_X[0]) < std::fabs(x - CHEST_X[1]) ? CHEST_X[0] : CHEST_X[1];
+    action[0] = clamp_axis((target - x) * 0.5f - velocity_x);
+    action[1] = velocity_y < -SAFE_DESCENT_SPEED ? 1.0f : 0.0f;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *name = NULL;
+    long step_count  = 10000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc) step_count = atol(argv[++i]);
+        else if (name == NULL && argv[i][0] != '-')          name = argv[i];
+        else
+        {
+            fprintf(stderr, "Unknown argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (name == NULL)
+    {
+        fprintf(stderr, "Usage: bridge_client <shared memory name> [--steps <count>]\n");
+        return 1;
+    }
+
+    Bridge bridge;
+    for (int attempt = 0; attempt < ATTACH_ATTEMPTS && !bridge.open(name); attempt++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    if (!bridge.is_open())
+    {
+        fprintf(stderr, "No training bridge at %s; start the game with --bridge %s\n", name, name);
+        return 1;
+    }
+
+    int env_count          = bridge.get_env_count();
+    int observation_size   = bridge.get_observation_size();
+    int action_size        = bridge.get_action_size();
+    const float *observations = bridge.get_observations();
+    float *actions            = bridge.get_actions();
+    const float *rewards      = bridge.get_rewards();
+    const uint8_t *dones      = bridge.get_dones();
+
+    printf("Attached to %s: %d landers, %d observations, %d actions and a %d-byte image each\n", name, env_count,
+           observation_size, action_size, bridge.get_image_size());
+
+    bridge.send(BRIDGE_RESET);
+
+    long episodes = 0, landings = 0, stings = 0;
+    double total_reward = 0.0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (long step = 0; step < step_count; step++)
+    {
+        for (int i = 0; i < env_count; i++)
+        {
+            choose_action(observations + (size_t) i * observation_size, actions + (size_t) i * action_size);
+        }
+
+        bridge.send(BRIDGE_STEP);
+
+        for (int i = 0; i < env_count; i++)
+        {
+            if (!dones[i]) continue;
+
+            episodes++;
+            landings     += rewards[i] > 0.0f;
+            stings       += rewards[i] < 0.0f;
+            total_reward += rewards[i];
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // What the last step's images show, as a check that they are arriving
+    long cells[OCCUPANCY_CHANNELS] = {};
+    for (int i = 0; bridge.get_image_size() >= (int) OCCUPANCY_GRID_BYTES && i < env_count; i++)
+    {
+        const uint8_t *grid = bridge.get_images() + (size_t) i * bridge.get_image_stride();
+        for (size_t cell = 0; cell < OCCUPANCY_GRID_BYTES; cell++) cells[cell / OCCUPANCY_PLANE_BYTES] += grid[cell];
+    }
+
+    bridge.send(BRIDGE_QUIT);
+
+    printf("%ld steps in %.3f s: %.1f us per step, %.0f lander steps per second\n", step_count, seconds,
+           seconds * 1e6 / step_count, step_count * (double) env_count / seconds);
+    printf("%ld episodes: %ld landings, %ld stings, %ld timed out, mean reward %.2f\n", episodes, landings, stings,
+           episodes - landings - stings, episodes > 0 ? total_reward / episodes : 0.0);
+    printf("Occupied cells per lander in the last images: %.1f chest, %.1f jellyfish, %.1f wall\n",
+           cells[OCCUPANCY_CHESTS] / (double) env_count, cells[OCCUPANCY_JELLYFISH] / (double) env_count,
+           cells[OCCUPANCY_WALLS] / (double) env_count);
+    return 0;
+}
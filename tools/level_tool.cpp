@@ -0,0 +1,141 @@
+/**
+ * Generates a streamed seabed level for the game's --level flag: a strip of
+ * chunks as many screens wide as asked for, scattered with jellyfish and the
+ * odd treasure chest, and one last chest at the far end.
+ *
+ * Build from the repository root:
+ *
+ *     c++ -std=c++17 -O2 -I. tools/level_tool.cpp -o level_tool
+ *
+ * Usage:
+ *
+ *     level_tool <output.lvl> [--screens <count>] [--seed <number>]
+ *
+ * The format is described in LevelStream.h. Output is deterministic for a
+ * given seed, so a level can be regenerated instead of checked in.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "LevelStream.h"
+
+const float CHUNK_SIZE     = 8.0f;
+const float SCREEN_WIDTH   = 10.0f;
+const float ORIGIN_X       = -5.0f,
+            ORIGIN_Y       = -3.75f;
+const float SPAWN_CLEARING = 4.0f;    // no jellyfish this close to the spawn point
+const float SEABED_CHEST_Y = -2.5f;
+const int   MAX_JELLYFISH  = 4;       // per chunk
+const float CHEST_CHANCE   = 0.1f;    // per chunk
+
+static bool overlaps(const LevelPlatform &a, const LevelPlatform &b)
+{
+    return std::abs(a.x - b.x) * 2.0f < a.width + b.width && std::abs(a.y - b.y) * 2.0f < a.height + b.height;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *output_path = NULL;
+    int screens             = 1000;
+    unsigned int seed       = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if      (strcmp(argv[i], "--screens") == 0 && i + 1 < argc) screens = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)    seed = (unsigned int) strtoul(argv[++i], NULL, 10);
+        else                                                          output_path = argv[i];
+    }
+
+    if (output_path == NULL || screens < 1)
+    {
+        fprintf(stderr, "Usage: level_tool <output.lvl> [--screens <count>] [--seed <number>]\n");
+        return 1;
+    }
+
+    LevelHeader header;
+    memcpy(header.magic, LEVEL_MAGIC, sizeof(header.magic));
+    header.version    = LEVEL_VERSION;
+    header.chunk_size = CHUNK_SIZE;
+    header.chunk_cols = (int32_t) ((screens * SCREEN_WIDTH + CHUNK_SIZE - 1.0f) / CHUNK_SIZE);
+    header.chunk_rows = 1;
+    header.origin_x   = ORIGIN_X;
+    header.origin_y   = ORIGIN_Y;
+    header.spawn_x    = 0.0f;
+    header.spawn_y    = 0.0f;
+
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::vector<LevelChunkEntry> chunks(header.chunk_cols);
+    std::vector<LevelPlatform> platforms;
+
+    for (int column = 0; column < header.chunk_cols; column++)
+    {
+        float left = ORIGIN_X + column * CHUNK_SIZE;
+        size_t first = platforms.size();
+
+        std::vector<LevelPlatform> chunk;
+        bool is_last = column == header.chunk_cols - 1;
+
+        if (is_last || unit(random) < CHEST_CHANCE)
+        {
+            LevelPlatform chest = { left + CHUNK_SIZE * 0.5f, SEABED_CHEST_Y, 1.75f, 1.25f, LEVEL_TREASURE };
+            if (std::abs(chest.x - header.spawn_x) > SPAWN_CLEARING) chunk.push_back(chest);
+        }
+
+        int jellyfish = (int) (unit(random) * (MAX_JELLYFISH + 1));
+        for (int i = 0; i < jellyfish; i++)
+        {
+            // A few tries to find a free spot; a crowded chunk just gets fewer
+            for (int attempt = 0; attempt < 8; attempt++)
+            {
+                LevelPlatform candidate;
+                candidate.width  = 0.8f + unit(random) * 0.7f;
+                candidate.height = 1.5f + unit(random) * 0.5f;
+                candidate.x      = left + candidate.width / 2.0f + unit(random) * (CHUNK_SIZE - candidate.width);
+                candidate.y      = -1.0f + unit(random) * 4.0f;
+                candidate.type   = LEVEL_JELLYFISH;
+
+                if (std::abs(candidate.x - header.spawn_x) < SPAWN_CLEARING &&
+                    std::abs(candidate.y - header.spawn_y) < SPAWN_CLEARING) continue;
+
+                bool is_free = true;
+                for (const LevelPlatform &other : chunk) is_free = is_free && !overlaps(candidate, other);
+                if (!is_free) continue;
+
+                chunk.push_back(candidate);
+                break;
+            }
+        }
+
+        platforms.insert(platforms.end(), chunk.begin(), chunk.end());
+        chunks[column].first_platform = (uint32_t) first;
+        chunks[column].platform_count = (uint32_t) chunk.size();
+    }
+
+    FILE *file = fopen(output_path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Unable to write %s\n", output_path);
+        return 1;
+    }
+
+    bool is_written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                      fwrite(chunks.data(), sizeof(LevelChunkEntry), chunks.size(), file) == chunks.size() &&
+                      fwrite(platforms.data(), sizeof(LevelPlatform), platforms.size(), file) == platforms.size();
+    is_written = fclose(file) == 0 && is_written;
+
+    if (!is_written)
+    {
+        fprintf(stderr, "Unable to write %s\n", output_path);
+        return 1;
+    }
+
+    printf("%s: %d screens, %d chunks, %zu platforms\n", output_path, screens, header.chunk_cols, platforms.size());
+    return 0;
+}
@@ -0,0 +1,81 @@
+// One private copy of stb_image per build of this file, so png_simd_check can
+// link the generic and the STBI_PNG_SIMD decoders side by side. Compile it
+// once with -DPNG_DECODE=decode_png_scalar and once with
+// -DSTBI_PNG_SIMD -DPNG_DECODE=decode_png_simd; each build also defines
+// PNG_DECODE with _file appended.
+
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+
+#include <cstdlib>
+#include <cstring>
+#include "stb_image.h"
+
+#define PASTE_NAME(name, suffix) name##suffix
+#define SUFFIXED(name, suffix)   PASTE_NAME(name, suffix)
+
+// How decode_png_*_file() loads: stbi_load(), or stbi_load_png_into() with a
+// callback that supplies a buffer or one that declines
+enum PngLoad { PNG_LOAD, PNG_LOAD_INTO, PNG_LOAD_INTO_DECLINED };
+
+struct OutputBuffer
+{
+    bool is_declined;
+    unsigned char *pixels;
+};
+
+static stbi_uc *supply_output(void *user, int x, int y, int comp)
+{
+    OutputBuffer *output = (OutputBuffer *) user;
+    if (output->is_declined) return NULL;
+
+    // Filled with junk, so a pixel the decoder skips shows up as a mismatch
+    size_t size = (size_t) x * y * comp;
+    free(output->pixels);
+    output->pixels = (unsigned char *) malloc(size);
+    memset(output->pixels, 0xCD, size);
+    return output->pixels;
+}
+
+// Hands back a malloc'd copy so the caller never needs this copy's stbi_image_free
+static unsigned char *copy_pixels(unsigned char *pixels, int width, int height, int channels)
+{
+    size_t size = (size_t) width * height * channels;
+    unsigned char *copy = (unsigned char *) malloc(size);
+    memcpy(copy, pixels, size);
+    stbi_image_free(pixels);
+    return copy;
+}
+
+unsigned char *PNG_DECODE(const unsigned char *buffer, int length, int *width, int *height, int *components,
+                          int requested_components)
+{
+    unsigned char *pixels = stbi_load_from_memory(buffer, length, width, height, components, requested_components);
+    if (pixels == NULL) return NULL;
+
+    return copy_pixels(pixels, *width, *height, requested_components ? requested_components : *components);
+}
+
+unsigned char *SUFFIXED(PNG_DECODE, _file)(const char *filepath, int load, int *width, int *height,
+                                           int *components, int requested_components)
+{
+    if (load == PNG_LOAD)
+    {
+        unsigned char *pixels = stbi_load(filepath, width, height, components, requested_components);
+        if (pixels == NULL) return NULL;
+
+        return copy_pixels(pixels, *width, *height, requested_components ? requested_components : *components);
+    }
+
+    OutputBuffer output = { load == PNG_LOAD_INTO_DECLINED, NULL };
+    unsigned char *pixels = stbi_load_png_into(filepath, width, height, components, requested_components,
+                                               supply_output, &output);
+
+    // The supplied buffer is already malloc'd; anything else came from stb_image
+    if (pixels != NULL && pixels == output.pixels) return pixels;
+    free(output.pixels);
+    if (pixels == NULL) return NULL;
+
+    return copy_pixels(pixels, *width, *height, requested_components ? requested_components : *components);
+}